@@ -0,0 +1,102 @@
+/*
+ * File:   debug_log.c
+ * Author: MSI
+ *
+ * Created on October 18, 2026
+ */
+
+#include <xc.h>
+#include <string.h>
+
+#include "debug_log.h"
+
+#if DEBUG_LEVEL > LOG_LEVEL_NONE
+
+#define DEBUG_LOG_MASK (DEBUG_LOG_SIZE - 1)
+
+//Log Ring Buffer, written by the main loop only, drained by the DRE interrupt
+static volatile uint8_t log_ring[DEBUG_LOG_SIZE];
+static volatile uint16_t log_head = 0;
+static volatile uint16_t log_tail = 0;
+
+//Messages dropped since the last drop notice
+static uint32_t log_dropped_pending = 0;
+
+/////////////////////////////////////////////////////////////////////////////
+
+//This function returns the free space in the ring, one slot stays empty
+static uint16_t log_space(void){
+    return (uint16_t)(DEBUG_LOG_MASK - ((log_head - log_tail) & DEBUG_LOG_MASK));
+}
+
+//This function copies bytes into the ring, the caller has checked the space
+static void log_put(const char *data, uint16_t len){
+    uint16_t head = log_head;
+
+    for (uint16_t i = 0; i < len; i++){
+        log_ring[head] = (uint8_t)data[i];
+        head = (head + 1) & DEBUG_LOG_MASK;
+    }
+
+    log_head = head;
+}
+
+//This function builds the drop notice, returns its length
+static uint16_t log_drop_notice(char *out, uint32_t count){
+    char digits[10];
+    uint16_t n = 0, len = 0;
+
+    do {
+        digits[n++] = (char)('0' + count % 10);
+        count /= 10;
+    } while (count != 0);
+
+    memcpy(out, "#LOG,dropped,", 13);
+    len = 13;
+    while (n > 0) out[len++] = digits[--n];
+    out[len++] = '\r';
+    out[len++] = '\n';
+
+    return len;
+}
+
+//This function queues a message for the debug port, it never waits on the UART
+void debug_log_write(const char *message){
+    char notice[32];
+    uint16_t notice_len = 0;
+
+    if (message == NULL) return;
+
+    size_t len = strlen(message);
+    if (log_dropped_pending != 0) notice_len = log_drop_notice(notice, log_dropped_pending);
+
+    //Whole messages only, a torn line is worse than a missing one
+    if (len + notice_len > log_space()){
+        log_dropped_pending++;
+        return;
+    }
+
+    if (notice_len != 0){
+        log_put(notice, notice_len);
+        log_dropped_pending = 0;
+    }
+    log_put(message, (uint16_t)len);
+
+    //Data Register Empty interrupt takes it from here
+    SERCOM3_REGS->USART_INT.SERCOM_INTENSET = (0x1 << 0);
+}
+
+//SERCOM3 DRE Interrupt, one byte per interrupt until the ring is empty
+void SERCOM3_0_Handler(void){
+    uint16_t tail = log_tail;
+
+    if (tail == log_head){
+        SERCOM3_REGS->USART_INT.SERCOM_INTENCLR = (0x1 << 0);
+        return;
+    }
+
+    SERCOM3_REGS->USART_INT.SERCOM_DATA = log_ring[tail];
+    log_tail = (tail + 1) & DEBUG_LOG_MASK;
+}
+
+#endif /* DEBUG_LEVEL > LOG_LEVEL_NONE */
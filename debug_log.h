@@ -0,0 +1,75 @@
+/*
+ * File:   debug_log.h
+ * Author: MSI
+ *
+ * Created on October 18, 2026
+ */
+
+#ifndef DEBUG_LOG_H
+#define DEBUG_LOG_H
+
+#include <stdint.h>
+
+/* DEBUG LOG
+ *
+ * Debug text goes out of SERCOM3 on its own channel, separate from the HC12
+ * link. It consists of the following:
+ * [1] Compile-time levels, a message above DEBUG_LEVEL is not compiled in
+ * [2] A ring buffer drained by the SERCOM3 DRE interrupt, so logging never
+ *     waits on the UART
+ * [3] A message that does not fit is dropped and counted; the next one that
+ *     fits is preceded by a "#LOG,dropped,<n>" line
+ *
+ * Defining FLIGHT_BUILD forces DEBUG_LEVEL to LOG_LEVEL_NONE, which removes
+ * every log call, the ring buffer and the SERCOM3 setup.
+ */
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_TRACE 3
+
+#ifdef FLIGHT_BUILD
+#undef DEBUG_LEVEL
+#define DEBUG_LEVEL LOG_LEVEL_NONE
+#endif
+
+#ifndef DEBUG_LEVEL
+#define DEBUG_LEVEL LOG_LEVEL_INFO
+#endif
+
+//Debug port speed, 16x oversampling off the 4 MHz GCLK caps it at 250000 bps
+#ifndef DEBUG_BAUD
+#define DEBUG_BAUD 115200
+#endif
+
+#if DEBUG_BAUD > 250000
+#error "DEBUG_BAUD is above what SERCOM3 can do from the 4 MHz GCLK"
+#endif
+
+//Ring buffer size, must be a power of 2
+#define DEBUG_LOG_SIZE 512
+
+#if DEBUG_LEVEL > LOG_LEVEL_NONE
+void debug_log_write(const char *message);
+#endif
+
+#if DEBUG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(message) debug_log_write(message)
+#else
+#define LOG_ERROR(message) ((void)0)
+#endif
+
+#if DEBUG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(message) debug_log_write(message)
+#else
+#define LOG_INFO(message) ((void)0)
+#endif
+
+#if DEBUG_LEVEL >= LOG_LEVEL_TRACE
+#define LOG_TRACE(message) debug_log_write(message)
+#else
+#define LOG_TRACE(message) ((void)0)
+#endif
+
+#endif /* DEBUG_LOG_H */
@@ -0,0 +1,155 @@
+/*
+ * File:   hc12_frame.c
+ * Author: MSI
+ *
+ * Created on October 18, 2026
+ */
+
+#include <string.h>
+
+#include "hc12_frame.h"
+
+//Result of checking the bytes collected so far by the parser
+#define FRAME_NEED_MORE 0
+#define FRAME_BAD 1
+#define FRAME_BAD_CRC 2
+#define FRAME_COMPLETE 3
+
+/////////////////////////////////////////////////////////////////////////////
+
+//This function computes the CRC-16/CCITT (poly 0x1021) of a block of data
+uint16_t hc12_crc16(uint16_t crc, const uint8_t *data, uint32_t len){
+    while (len--){
+        crc ^= (uint16_t)(*data++) << 8;
+        for (int i = 0; i < 8; i++){
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+//This function wraps a payload into a frame and returns the frame length
+uint32_t hc12_frame_encode(uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len, uint8_t *out){
+    if (len > HC12_MAX_PAYLOAD) len = HC12_MAX_PAYLOAD;
+
+    //Frame Header
+    out[0] = HC12_SYNC0;
+    out[1] = HC12_SYNC1;
+    out[2] = type;
+    out[3] = (uint8_t)(seq & 0xFF);
+    out[4] = (uint8_t)(seq >> 8);
+    out[5] = (uint8_t)(len & 0xFF);
+    out[6] = (uint8_t)(len >> 8);
+
+    //Payload
+    memcpy(&out[HC12_HEADER_LEN], payload, len);
+
+    //CRC over everything after the sync bytes
+    uint16_t crc = hc12_crc16(0xFFFF, &out[2], HC12_HEADER_LEN - 2 + len);
+    out[HC12_HEADER_LEN + len] = (uint8_t)(crc & 0xFF);
+    out[HC12_HEADER_LEN + len + 1] = (uint8_t)(crc >> 8);
+
+    return HC12_HEADER_LEN + len + HC12_CRC_LEN;
+}
+
+static void put_u32(uint8_t *out, uint32_t value){
+    out[0] = (uint8_t)(value & 0xFF);
+    out[1] = (uint8_t)((value >> 8) & 0xFF);
+    out[2] = (uint8_t)((value >> 16) & 0xFF);
+    out[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t get_u32(const uint8_t *in){
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+//This function writes the trace block at the start of a telemetry payload
+void hc12_trace_put(uint8_t *out, const HC12_Trace *trace){
+    put_u32(&out[0], trace->acquire_ms);
+    put_u32(&out[4], trace->ready_ms);
+    put_u32(&out[8], trace->tx_start_ms);
+    put_u32(&out[12], trace->prev_tx_end_ms);
+}
+
+//This function reads the trace block back
+void hc12_trace_get(const uint8_t *in, HC12_Trace *trace){
+    trace->acquire_ms = get_u32(&in[0]);
+    trace->ready_ms = get_u32(&in[4]);
+    trace->tx_start_ms = get_u32(&in[8]);
+    trace->prev_tx_end_ms = get_u32(&in[12]);
+}
+
+/* FRAME PARSER FUNCTIONS
+ *
+ * The parser collects the raw bytes of the frame it is currently working on.
+ * Whenever the collected bytes can no longer be a valid frame, the first
+ * byte is dropped and the search restarts at the next sync byte already in
+ * the buffer, so a corrupted header never swallows the frame behind it.
+ */
+
+void hc12_parser_reset(HC12_Parser *parser){
+    memset(parser, 0, sizeof(*parser));
+}
+
+//This function checks whether the collected bytes form a frame
+static int frame_check(const HC12_Parser *parser){
+    const uint8_t *buf = parser->buf;
+    uint16_t count = parser->count;
+
+    if (count >= 1 && buf[0] != HC12_SYNC0) return FRAME_BAD;
+    if (count >= 2 && buf[1] != HC12_SYNC1) return FRAME_BAD;
+    if (count < HC12_HEADER_LEN) return FRAME_NEED_MORE;
+
+    uint16_t len = (uint16_t)(buf[5] | (buf[6] << 8));
+    if (len > HC12_MAX_PAYLOAD) return FRAME_BAD;
+    if (count < HC12_HEADER_LEN + len + HC12_CRC_LEN) return FRAME_NEED_MORE;
+
+    uint16_t crc = hc12_crc16(0xFFFF, &buf[2], HC12_HEADER_LEN - 2 + len);
+    uint16_t rcvd_crc = (uint16_t)(buf[HC12_HEADER_LEN + len] | (buf[HC12_HEADER_LEN + len + 1] << 8));
+
+    return (crc == rcvd_crc) ? FRAME_COMPLETE : FRAME_BAD_CRC;
+}
+
+//This function drops the first n bytes and moves to the next sync byte
+static void frame_discard(HC12_Parser *parser, uint16_t n){
+    while (n < parser->count && parser->buf[n] != HC12_SYNC0){
+        n++;
+    }
+
+    parser->count -= n;
+    memmove(parser->buf, &parser->buf[n], parser->count);
+}
+
+//This function feeds one byte to the parser, returns true once a frame is decoded
+bool hc12_parser_feed(HC12_Parser *parser, uint8_t data){
+    parser->buf[parser->count++] = data;
+
+    while (1){
+        int result = frame_check(parser);
+
+        if (result == FRAME_NEED_MORE){
+            return false;
+        }
+
+        if (result == FRAME_BAD || result == FRAME_BAD_CRC){
+            //Only count it if we were actually inside a frame
+            if (parser->count > 2) parser->resyncs++;
+            if (result == FRAME_BAD_CRC) parser->crc_errors++;
+            frame_discard(parser, 1);
+            continue;
+        }
+
+        //Copy out the decoded frame
+        HC12_Frame *frame = &parser->frame;
+        frame->type = parser->buf[2];
+        frame->seq = (uint16_t)(parser->buf[3] | (parser->buf[4] << 8));
+        frame->len = (uint16_t)(parser->buf[5] | (parser->buf[6] << 8));
+        memcpy(frame->payload, &parser->buf[HC12_HEADER_LEN], frame->len);
+        parser->frames++;
+
+        //Keep whatever came after this frame
+        frame_discard(parser, HC12_HEADER_LEN + frame->len + HC12_CRC_LEN);
+        return true;
+    }
+}
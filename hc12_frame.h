@@ -0,0 +1,95 @@
+/*
+ * File:   hc12_frame.h
+ * Author: MSI
+ *
+ * Created on October 18, 2026
+ */
+
+#ifndef HC12_FRAME_H
+#define HC12_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* HC12 FRAME FORMAT
+ *
+ * Every message sent over the HC12 link is wrapped in a frame so that the
+ * receiver can find the start of the next message again after lost or
+ * corrupted bytes. A frame is made up of the following:
+ * [1] Sync Bytes (0xA5 0x5A)
+ * [2] Frame Type (1 byte)
+ * [3] Sequence Number (2 bytes, little endian)
+ * [4] Payload Length (2 bytes, little endian)
+ * [5] Payload
+ * [6] CRC-16/CCITT over [2] to [5] (2 bytes, little endian)
+ */
+
+#define HC12_SYNC0 0xA5
+#define HC12_SYNC1 0x5A
+
+#define HC12_HEADER_LEN 7
+#define HC12_CRC_LEN 2
+#define HC12_MAX_PAYLOAD 336
+#define HC12_MAX_FRAME (HC12_HEADER_LEN + HC12_MAX_PAYLOAD + HC12_CRC_LEN)
+
+//Frame Types
+#define HC12_TYPE_TELEMETRY 0x01
+#define HC12_TYPE_NACK 0x02
+
+/* TELEMETRY Payload
+ * [1] Trace Block (HC12_TRACE_LEN bytes, little endian, transmitter clock in ms)
+ * [2] Report text, at most HC12_MAX_REPORT bytes
+ *
+ * The trace block stamps the frame at each stage of the transmitter so the
+ * ground can work out how old the data is. The end of the UART transmission
+ * is only known once the frame is gone, so it travels in the next frame.
+ */
+#define HC12_TRACE_LEN 16
+#define HC12_MAX_REPORT (HC12_MAX_PAYLOAD - HC12_TRACE_LEN)
+
+/* NACK Payload (ground to transmitter)
+ * [1] First missing sequence number (2 bytes, little endian)
+ * [2] Number of consecutive missing frames (1 byte)
+ *
+ * The transmitter keeps the last HC12_HISTORY_DEPTH frames and resends the
+ * ones it still has; older sequence numbers are gone for good.
+ */
+#define HC12_NACK_LEN 3
+#define HC12_HISTORY_DEPTH 8
+
+// Structure to hold a decoded frame
+typedef struct {
+    uint8_t type;
+    uint16_t seq;
+    uint16_t len;
+    uint8_t payload[HC12_MAX_PAYLOAD];
+} HC12_Frame;
+
+// Structure to hold the trace stamps of a telemetry frame
+typedef struct {
+    uint32_t acquire_ms;     // First sensor read of the cycle
+    uint32_t ready_ms;       // All readings in, report formatting starts
+    uint32_t tx_start_ms;    // Frame built, first byte handed to the UART
+    uint32_t prev_tx_end_ms; // Last byte of the previous live frame left the UART, 0 if unknown
+} HC12_Trace;
+
+// Structure to hold the state of the frame parser
+typedef struct {
+    uint8_t buf[HC12_MAX_FRAME];
+    uint16_t count;
+    HC12_Frame frame;
+
+    //Link statistics
+    uint32_t frames;
+    uint32_t crc_errors;
+    uint32_t resyncs;
+} HC12_Parser;
+
+uint16_t hc12_crc16(uint16_t crc, const uint8_t *data, uint32_t len);
+uint32_t hc12_frame_encode(uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len, uint8_t *out);
+void hc12_trace_put(uint8_t *out, const HC12_Trace *trace);
+void hc12_trace_get(const uint8_t *in, HC12_Trace *trace);
+void hc12_parser_reset(HC12_Parser *parser);
+bool hc12_parser_feed(HC12_Parser *parser, uint8_t data);
+
+#endif /* HC12_FRAME_H */
@@ -0,0 +1,438 @@
+/*
+ * File:   latency_report.c
+ * Author: MSI
+ *
+ * Created on October 18, 2026
+ *
+ * Ground-side tool (not part of the firmware) that answers "how old is the
+ * data on the ground screen?". It reads the #T trace lines the receiver
+ * forwards for every live frame:
+ *   #T,<seq>,<payload len>,<acquire>,<ready>,<tx start>,<prev tx end>,<rx>
+ * where the first four stamps come from the transmitter's clock (carried in
+ * the frame) and <rx> from the receiver's clock. From them it builds
+ * per-stage and end-to-end latency histograms with p50/p99/max.
+ *
+ * The two clocks are not synchronised. Their offset is estimated as the
+ * smallest (rx - tx end) in each window of frames, interpolated between
+ * windows to follow drift, so the radio and end-to-end figures are measured
+ * against the fastest frame of the window plus the -f floor.
+ *
+ * With -s the tool instead simulates the link on Linux: the transmitter's
+ * frames are built with hc12_frame_encode(), every byte is timed at the
+ * given baud (10 bits per byte), delayed by the HC-12 link latency and fed
+ * through the receiver's hc12_parser_feed(); the receiver clock has its own
+ * offset and drift. The simulation also prints the true end-to-end latency
+ * so the estimate can be checked against it.
+ *
+ * Build:  gcc -O2 -o latency_report host/latency_report.c hc12_frame.c -lm
+ * Usage:  latency_report [-f floor_ms] [-w window] capture...
+ *         latency_report -s frames [-b baud] [-l link_ms] [-j jitter_ms]
+ *                        [-d drop] [-o offset_ms] [-p drift_ppm] [-f floor_ms]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "../hc12_frame.h"
+
+#define MAX_RECORDS 1000000
+#define DEFAULT_WINDOW 64
+#define HISTOGRAM_BUCKETS 16
+#define HISTOGRAM_WIDTH 50
+
+// Structure to hold one #T line
+typedef struct {
+    uint32_t seq;  // unwrapped
+    uint16_t len;
+    uint32_t acquire_ms;
+    uint32_t ready_ms;
+    uint32_t tx_start_ms;
+    uint32_t prev_tx_end_ms;
+    uint32_t rx_ms;
+} Trace_Record;
+
+// Structure to hold the samples of one stage
+typedef struct {
+    const char *name;
+    double *values;
+    size_t count;
+} Stage;
+
+// Structure to hold the simulated link settings
+typedef struct {
+    long frames;
+    double baud;
+    double link_ms;
+    double jitter_ms;
+    double drop;
+    double offset_ms;
+    double drift_ppm;
+} Sim_Config;
+
+static Trace_Record *records;
+static size_t record_count = 0;
+
+//Signed difference of two wrapping millisecond stamps
+static double ms_diff(uint32_t later, uint32_t earlier){
+    return (double)(int32_t)(later - earlier);
+}
+
+//This function appends a record, unwrapping the 16-bit sequence number
+static void add_record(uint16_t seq, uint16_t len, const HC12_Trace *trace, uint32_t rx_ms){
+    if (record_count == MAX_RECORDS) return;
+
+    Trace_Record *r = &records[record_count];
+    uint32_t unwrapped = seq;
+
+    if (record_count > 0){
+        uint32_t prev = records[record_count - 1].seq;
+        unwrapped = prev + (uint16_t)(seq - (uint16_t)prev);
+    }
+
+    r->seq = unwrapped;
+    r->len = len;
+    r->acquire_ms = trace->acquire_ms;
+    r->ready_ms = trace->ready_ms;
+    r->tx_start_ms = trace->tx_start_ms;
+    r->prev_tx_end_ms = trace->prev_tx_end_ms;
+    r->rx_ms = rx_ms;
+    record_count++;
+}
+
+/* STATISTICS FUNCTIONS
+ *
+ * The following functions summarise the stage samples. It consists of the following:
+ * [1] Stage Add
+ * [2] Percentile
+ * [3] Stage Print (p50/p99/max and a histogram)
+ */
+
+static void stage_add(Stage *stage, double value){
+    stage->values[stage->count++] = value;
+}
+
+static int compare_double(const void *a, const void *b){
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+//Nearest-rank percentile of sorted values
+static double percentile(const double *sorted, size_t count, double p){
+    size_t rank = (size_t)ceil(p / 100.0 * count);
+    if (rank < 1) rank = 1;
+    return sorted[rank - 1];
+}
+
+static void stage_print(Stage *stage, bool histogram){
+    if (stage->count == 0){
+        printf("%-22s %8s\n", stage->name, "no data");
+        return;
+    }
+
+    qsort(stage->values, stage->count, sizeof(double), compare_double);
+    double *v = stage->values;
+
+    printf("%-22s %8zu %9.1f %9.1f %9.1f %9.1f\n", stage->name, stage->count,
+           v[0], percentile(v, stage->count, 50), percentile(v, stage->count, 99), v[stage->count - 1]);
+
+    if (!histogram) return;
+
+    //Whole-millisecond buckets spanning min to max
+    size_t buckets[HISTOGRAM_BUCKETS] = {0};
+    size_t peak = 0;
+    double lo = floor(v[0]);
+    double width = ceil((v[stage->count - 1] - lo + 1) / HISTOGRAM_BUCKETS);
+
+    for (size_t i = 0; i < stage->count; i++){
+        int b = (int)((v[i] - lo) / width);
+        if (b >= HISTOGRAM_BUCKETS) b = HISTOGRAM_BUCKETS - 1;
+        if (++buckets[b] > peak) peak = buckets[b];
+    }
+
+    for (int b = 0; b < HISTOGRAM_BUCKETS; b++){
+        int bar = (int)((double)buckets[b] * HISTOGRAM_WIDTH / peak);
+        printf("    %7.0f - %-7.0f ms %8zu |%.*s\n", lo + b * width, lo + (b + 1) * width, buckets[b], bar,
+               "##################################################");
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+//Offset estimate at the centre of each window: rx clock - tx clock at tx end
+typedef struct {
+    double tx_ms;
+    double offset_ms;
+} Offset_Point;
+
+//This function returns the interpolated clock offset at a transmitter time
+static double offset_at(const Offset_Point *points, size_t count, double tx_ms){
+    if (count == 1 || tx_ms <= points[0].tx_ms) return points[0].offset_ms;
+    if (tx_ms >= points[count - 1].tx_ms) return points[count - 1].offset_ms;
+
+    size_t i = 1;
+    while (points[i].tx_ms < tx_ms) i++;
+
+    double f = (tx_ms - points[i - 1].tx_ms) / (points[i].tx_ms - points[i - 1].tx_ms);
+    return points[i - 1].offset_ms + f * (points[i].offset_ms - points[i - 1].offset_ms);
+}
+
+//This function works out the stages of every record and prints the report
+static void analyse(double baud, double floor_ms, size_t window, const double *truth, size_t truth_count){
+    if (record_count == 0){
+        printf("no #T records\n");
+        return;
+    }
+
+    double *tx_end = malloc(record_count * sizeof(double));
+    bool *measured = malloc(record_count * sizeof(bool));
+    Offset_Point *points = malloc((record_count / window + 2) * sizeof(Offset_Point));
+    size_t point_count = 0, measured_count = 0;
+
+    Stage stages[5] = {
+        { "acquire -> ready", NULL, 0 }, { "ready -> tx start", NULL, 0 },
+        { "tx start -> tx end", NULL, 0 }, { "tx end -> ground rx", NULL, 0 },
+        { "end-to-end", NULL, 0 },
+    };
+    for (int i = 0; i < 5; i++) stages[i].values = malloc((record_count + 1) * sizeof(double));
+
+    //UART end of each frame: measured from the next frame when it arrived, else from the byte count
+    for (size_t i = 0; i < record_count; i++){
+        const Trace_Record *r = &records[i];
+        measured[i] = (i + 1 < record_count && records[i + 1].seq == r->seq + 1 && records[i + 1].prev_tx_end_ms != 0);
+
+        if (measured[i]){
+            tx_end[i] = r->tx_start_ms + ms_diff(records[i + 1].prev_tx_end_ms, r->tx_start_ms);
+            measured_count++;
+        } else {
+            double bytes = HC12_HEADER_LEN + r->len + HC12_CRC_LEN;
+            tx_end[i] = r->tx_start_ms + bytes * 10.0 * 1000.0 / baud;
+        }
+    }
+
+    //Minimum (rx - tx end) per window is the clock offset plus the fastest link delay
+    for (size_t start = 0; start < record_count; start += window){
+        size_t end = (start + window < record_count) ? start + window : record_count;
+        double best = INFINITY, centre = 0;
+
+        for (size_t i = start; i < end; i++){
+            double d = ms_diff(records[i].rx_ms, records[start].tx_start_ms) - (tx_end[i] - records[start].tx_start_ms);
+            if (d < best) best = d;
+            centre += tx_end[i] - records[start].tx_start_ms;
+        }
+
+        points[point_count].tx_ms = records[start].tx_start_ms + centre / (end - start);
+        points[point_count].offset_ms = best;
+        point_count++;
+    }
+
+    for (size_t i = 0; i < record_count; i++){
+        const Trace_Record *r = &records[i];
+        double offset = offset_at(points, point_count, tx_end[i]);
+        double rx_local = r->tx_start_ms + ms_diff(r->rx_ms, r->tx_start_ms) - offset + floor_ms;
+
+        stage_add(&stages[0], ms_diff(r->ready_ms, r->acquire_ms));
+        stage_add(&stages[1], ms_diff(r->tx_start_ms, r->ready_ms));
+        if (measured[i]) stage_add(&stages[2], tx_end[i] - r->tx_start_ms);
+        stage_add(&stages[3], rx_local - tx_end[i]);
+        stage_add(&stages[4], rx_local - r->acquire_ms);
+    }
+
+    uint32_t span = records[record_count - 1].seq - records[0].seq + 1;
+    printf("frames: %zu received of %lu sent (%.2f%% lost), %zu with measured tx end\n",
+           record_count, (unsigned long)span, 100.0 * (span - record_count) / span, measured_count);
+    printf("clock offset (rx - tx): %.1f ms at start, %.1f ms at end, floor %.1f ms\n\n",
+           points[0].offset_ms, points[point_count - 1].offset_ms, floor_ms);
+
+    printf("%-22s %8s %9s %9s %9s %9s\n", "stage (ms)", "count", "min", "p50", "p99", "max");
+    for (int i = 0; i < 5; i++) stage_print(&stages[i], false);
+
+    printf("\nend-to-end histogram\n");
+    stage_print(&stages[4], true);
+
+    if (truth != NULL){
+        Stage true_e2e = { "end-to-end (true)", malloc(truth_count * sizeof(double)), 0 };
+        for (size_t i = 0; i < truth_count; i++) stage_add(&true_e2e, truth[i]);
+
+        printf("\nsimulated ground truth\n");
+        printf("%-22s %8s %9s %9s %9s %9s\n", "stage (ms)", "count", "min", "p50", "p99", "max");
+        stage_print(&true_e2e, false);
+        free(true_e2e.values);
+    }
+
+    for (int i = 0; i < 5; i++) free(stages[i].values);
+    free(points);
+    free(measured);
+    free(tx_end);
+}
+
+/* INPUT FUNCTIONS
+ *
+ * The following functions produce trace records. It consists of the following:
+ * [1] Capture Reader (#T lines forwarded by the receiver)
+ * [2] Link Simulation
+ */
+
+static int read_capture(const char *path){
+    FILE *f = fopen(path, "r");
+    char line[256];
+
+    if (f == NULL){
+        perror(path);
+        return 1;
+    }
+
+    while (fgets(line, sizeof(line), f) != NULL){
+        unsigned seq, len;
+        unsigned long acquire, ready, tx_start, prev_tx_end, rx;
+
+        if (strncmp(line, "#T,", 3) != 0) continue;
+        if (sscanf(line + 3, "%u,%u,%lu,%lu,%lu,%lu,%lu", &seq, &len, &acquire, &ready,
+                   &tx_start, &prev_tx_end, &rx) != 7) continue;
+
+        HC12_Trace trace = { (uint32_t)acquire, (uint32_t)ready, (uint32_t)tx_start, (uint32_t)prev_tx_end };
+        add_record((uint16_t)seq, (uint16_t)len, &trace, (uint32_t)rx);
+    }
+
+    fclose(f);
+    return 0;
+}
+
+static double uniform(double lo, double hi){
+    return lo + (hi - lo) * ((double)rand() / RAND_MAX);
+}
+
+//Receiver clock reading at a true time (transmitter clock is the true time)
+static uint32_t rx_clock(const Sim_Config *cfg, double true_ms){
+    return (uint32_t)(int64_t)floor(true_ms * (1.0 + cfg->drift_ppm * 1e-6) + cfg->offset_ms);
+}
+
+//This function runs frames through a byte-timed model of the 9600-baud HC-12 link
+static double *simulate(const Sim_Config *cfg, size_t *truth_count){
+    static uint8_t frame[HC12_MAX_FRAME];
+    static uint8_t payload[HC12_MAX_PAYLOAD];
+    static HC12_Parser parser;
+    double *truth = malloc((size_t)cfg->frames * sizeof(double));
+    static double acquire_true[65536];
+    double byte_ms = 10.0 * 1000.0 / cfg->baud;
+    double now = 1000.0, last_tx_end = 0.0, last_arrival = 0.0;
+
+    hc12_parser_reset(&parser);
+    *truth_count = 0;
+
+    for (long k = 0; k < cfg->frames; k++){
+        HC12_Trace trace;
+
+        //Transmitter cycle: ADC reads, then the GPS sentence arrives somewhere in the second
+        double acquire = now;
+        double ready = acquire + uniform(2, 5) + uniform(0, 900);
+        double tx_start = ready + uniform(0.5, 2.0);
+
+        //Report text of a realistic length
+        int text_len = (int)uniform(260, 310);
+        memset(&payload[HC12_TRACE_LEN], 'x', (size_t)text_len);
+
+        trace.acquire_ms = (uint32_t)acquire;
+        trace.ready_ms = (uint32_t)ready;
+        trace.tx_start_ms = (uint32_t)tx_start;
+        trace.prev_tx_end_ms = (uint32_t)last_tx_end;
+        hc12_trace_put(payload, &trace);
+        acquire_true[(uint16_t)k] = acquire;
+
+        uint32_t n = hc12_frame_encode(HC12_TYPE_TELEMETRY, (uint16_t)k, payload,
+                                       (uint16_t)(HC12_TRACE_LEN + text_len), frame);
+
+        //A dropped frame gets one byte corrupted on air, the CRC throws it away
+        if (uniform(0, 1) < cfg->drop) frame[HC12_HEADER_LEN + (int)uniform(0, text_len)] ^= 0x20;
+
+        //Every byte: 10 bits on the UART, then the HC-12 link latency and jitter
+        double jitter = uniform(0, cfg->jitter_ms);
+        for (uint32_t i = 0; i < n; i++){
+            double arrival = tx_start + (i + 1) * byte_ms + cfg->link_ms + jitter;
+            if (arrival < last_arrival) arrival = last_arrival;
+            last_arrival = arrival;
+
+            if (hc12_parser_feed(&parser, frame[i])){
+                HC12_Trace rx_trace;
+                hc12_trace_get(parser.frame.payload, &rx_trace);
+                add_record(parser.frame.seq, parser.frame.len, &rx_trace, rx_clock(cfg, arrival));
+                truth[(*truth_count)++] = arrival - acquire_true[parser.frame.seq];
+            }
+        }
+
+        last_tx_end = tx_start + n * byte_ms;
+
+        //Next cycle starts after the frame is out, at the 1 s frame period at the earliest
+        now = (last_tx_end > acquire + 1000.0) ? last_tx_end : acquire + 1000.0;
+    }
+
+    return truth;
+}
+
+static void usage(const char *prog){
+    fprintf(stderr, "usage: %s [-f floor_ms] [-w window] capture...\n"
+                    "       %s -s frames [-b baud] [-l link_ms] [-j jitter_ms] [-d drop]\n"
+                    "          [-o offset_ms] [-p drift_ppm] [-f floor_ms] [-w window]\n", prog, prog);
+}
+
+// main() -- the heart of the program
+int main(int argc, char **argv){
+    Sim_Config cfg = { 0, 9600.0, 20.0, 10.0, 0.02, 123456.0, 40.0 };
+    double floor_ms = 0.0;
+    size_t window = DEFAULT_WINDOW;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:b:l:j:d:o:p:f:w:h")) != -1){
+        switch (opt){
+        case 's': cfg.frames = atol(optarg); break;
+        case 'b': cfg.baud = atof(optarg); break;
+        case 'l': cfg.link_ms = atof(optarg); break;
+        case 'j': cfg.jitter_ms = atof(optarg); break;
+        case 'd': cfg.drop = atof(optarg); break;
+        case 'o': cfg.offset_ms = atof(optarg); break;
+        case 'p': cfg.drift_ppm = atof(optarg); break;
+        case 'f': floor_ms = atof(optarg); break;
+        case 'w': window = (size_t)atol(optarg); break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (window == 0 || cfg.baud <= 0 || (cfg.frames <= 0 && optind >= argc)){
+        usage(argv[0]);
+        return 2;
+    }
+
+    records = malloc(MAX_RECORDS * sizeof(Trace_Record));
+    if (records == NULL){
+        perror("malloc");
+        return 1;
+    }
+
+    if (cfg.frames > 0){
+        size_t truth_count = 0;
+        if (cfg.frames > MAX_RECORDS) cfg.frames = MAX_RECORDS;
+
+        srand(1);
+        double *truth = simulate(&cfg, &truth_count);
+
+        printf("simulated %ld frames at %.0f baud, link %.1f ms + up to %.1f ms jitter, "
+               "%.1f%% dropped, receiver clock %+.0f ms %+.0f ppm\n\n",
+               cfg.frames, cfg.baud, cfg.link_ms, cfg.jitter_ms, cfg.drop * 100, cfg.offset_ms, cfg.drift_ppm);
+        analyse(cfg.baud, floor_ms, window, truth, truth_count);
+        free(truth);
+    } else {
+        for (int i = optind; i < argc; i++){
+            if (read_capture(argv[i]) != 0) return 1;
+        }
+        analyse(cfg.baud, floor_ms, window, NULL, 0);
+    }
+
+    free(records);
+    return 0;
+}
@@ -0,0 +1,868 @@
+/*
+ * File:   nmea_reprocess.c
+ * Author: MSI
+ *
+ * Created on October 18, 2026
+ *
+ * Workstation tool (not part of the firmware) for post-flight reprocessing
+ * of raw serial captures: NMEA from the GPS port and the transmitter's ASCII
+ * reports as forwarded by the receiver. Every capture is memory-mapped and
+ * split into chunks, one per thread. Each thread builds bitmasks of the
+ * '\n', '$', '*' and ',' delimiters for a 64 KB window at a time with
+ * AVX2 or SSE2 (64 bytes per step), then walks the masks to cut lines,
+ * validate NMEA checksums and convert GGA sentences and reports into the
+ * flight-log CSV format below.
+ *
+ * Build:  gcc -O2 -pthread -o nmea_reprocess host/nmea_reprocess.c -lm
+ * Usage:  nmea_reprocess [-t threads] [-o out.csv] [-r passes] [-m avx2|sse2|scalar] capture...
+ *         nmea_reprocess -S <MB> synth.txt    (write a synthetic capture)
+ *         nmea_reprocess -c -t <max> capture... (check the CSV is the same on 1..max threads)
+ *
+ * Flight-log CSV columns:
+ *   source,seq,local_time,lat,lon,alt_m,fix,sats,co2_ppm,temp_c,humidity_pct,pm_mg_m3,pressure_hpa,baro_alt_m
+ * where source is "gga" or "report"; columns a source does not carry are empty.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
+
+//Window of the capture scanned per pass, in 64-byte blocks
+#define WINDOW_BLOCKS 1024
+#define WINDOW_SIZE (WINDOW_BLOCKS * 64)
+
+//Same local time conversion as the transmitter (UTC+8)
+#define LOCAL_UTC_OFFSET 80000
+
+#define MAX_NMEA_FIELDS 20
+#define REPORT_HEADER "[D.L~N~R]"
+
+// Structure to hold the delimiter bitmasks of one window, bit i of block b is byte b*64+i
+typedef struct {
+    uint64_t nl[WINDOW_BLOCKS];
+    uint64_t dollar[WINDOW_BLOCKS];
+    uint64_t star[WINDOW_BLOCKS];
+    uint64_t comma[WINDOW_BLOCKS];
+} Block_Masks;
+
+// Structure to hold a growable output buffer
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} Out_Buffer;
+
+// Structure to hold a transmitter report while its lines come in
+typedef struct {
+    bool open;
+    long seq;
+    char time[16];
+    double lat, lon, alt, co2, temp, humid, pm, pressure, baro_alt;
+    bool has_pos, has_alt, has_co2, has_temp, has_humid, has_pm, has_pressure, has_baro_alt;
+} Report;
+
+// Structure to hold the counters of one thread
+typedef struct {
+    uint64_t bytes;
+    uint64_t lines;
+    uint64_t sentences;
+    uint64_t checksum_ok;
+    uint64_t checksum_bad;
+    uint64_t gga;
+    uint64_t reports;
+} Scan_Stats;
+
+// Structure to hold the work of one thread
+typedef struct {
+    const uint8_t *begin;
+    const uint8_t *end;
+    bool emit;      // keep the records for the output file, otherwise they are converted and dropped
+    Block_Masks masks;
+    Out_Buffer out;
+    Scan_Stats stats;
+    Report report;
+    long pending_seq;
+} Chunk_Job;
+
+typedef void (*Build_Masks_Fn)(const uint8_t *p, size_t nblocks, Block_Masks *m, size_t first);
+
+static Build_Masks_Fn build_masks;
+static const char *simd_name = "scalar";
+
+/////////////////////////////////////////////////////////////////////////////
+
+/* DELIMITER SCANNING FUNCTIONS
+ *
+ * The following functions build the delimiter bitmasks. It consists of the following:
+ * [1] Scalar Build Masks (fallback)
+ * [2] SSE2 Build Masks
+ * [3] AVX2 Build Masks
+ * [4] SIMD Selection
+ */
+
+static void build_masks_scalar(const uint8_t *p, size_t nblocks, Block_Masks *m, size_t first){
+    for (size_t b = 0; b < nblocks; b++){
+        uint64_t nl = 0, dollar = 0, star = 0, comma = 0;
+
+        for (int i = 0; i < 64; i++){
+            uint8_t c = p[b * 64 + i];
+            nl |= (uint64_t)(c == '\n') << i;
+            dollar |= (uint64_t)(c == '$') << i;
+            star |= (uint64_t)(c == '*') << i;
+            comma |= (uint64_t)(c == ',') << i;
+        }
+
+        m->nl[first + b] = nl;
+        m->dollar[first + b] = dollar;
+        m->star[first + b] = star;
+        m->comma[first + b] = comma;
+    }
+}
+
+#ifdef HAVE_X86_SIMD
+__attribute__((target("sse2")))
+static void build_masks_sse2(const uint8_t *p, size_t nblocks, Block_Masks *m, size_t first){
+    const __m128i nl = _mm_set1_epi8('\n');
+    const __m128i dollar = _mm_set1_epi8('$');
+    const __m128i star = _mm_set1_epi8('*');
+    const __m128i comma = _mm_set1_epi8(',');
+
+    for (size_t b = 0; b < nblocks; b++){
+        uint64_t mask_nl = 0, mask_dollar = 0, mask_star = 0, mask_comma = 0;
+
+        for (int i = 0; i < 4; i++){
+            __m128i v = _mm_loadu_si128((const __m128i *)(p + b * 64 + i * 16));
+            mask_nl |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl)) << (i * 16);
+            mask_dollar |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, dollar)) << (i * 16);
+            mask_star |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, star)) << (i * 16);
+            mask_comma |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, comma)) << (i * 16);
+        }
+
+        m->nl[first + b] = mask_nl;
+        m->dollar[first + b] = mask_dollar;
+        m->star[first + b] = mask_star;
+        m->comma[first + b] = mask_comma;
+    }
+}
+
+__attribute__((target("avx2")))
+static void build_masks_avx2(const uint8_t *p, size_t nblocks, Block_Masks *m, size_t first){
+    const __m256i nl = _mm256_set1_epi8('\n');
+    const __m256i dollar = _mm256_set1_epi8('$');
+    const __m256i star = _mm256_set1_epi8('*');
+    const __m256i comma = _mm256_set1_epi8(',');
+
+    for (size_t b = 0; b < nblocks; b++){
+        __m256i lo = _mm256_loadu_si256((const __m256i *)(p + b * 64));
+        __m256i hi = _mm256_loadu_si256((const __m256i *)(p + b * 64 + 32));
+
+        #define MASK64(c) ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, c)) | \
+                           ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, c)) << 32))
+        m->nl[first + b] = MASK64(nl);
+        m->dollar[first + b] = MASK64(dollar);
+        m->star[first + b] = MASK64(star);
+        m->comma[first + b] = MASK64(comma);
+        #undef MASK64
+    }
+}
+#endif
+
+//This function picks the widest SIMD the CPU supports, or the one asked for
+static void select_simd(const char *limit){
+    build_masks = build_masks_scalar;
+    simd_name = "scalar";
+
+    if (limit != NULL && strcmp(limit, "scalar") == 0) return;
+
+#ifdef HAVE_X86_SIMD
+    bool allow_avx2 = (limit == NULL || strcmp(limit, "avx2") == 0);
+
+    __builtin_cpu_init();
+    if (allow_avx2 && __builtin_cpu_supports("avx2")){
+        build_masks = build_masks_avx2;
+        simd_name = "avx2";
+    } else if (__builtin_cpu_supports("sse2")){
+        build_masks = build_masks_sse2;
+        simd_name = "sse2";
+    }
+#endif
+}
+
+//This function builds the masks of a window, the partial last block goes through a padded copy
+static void build_window_masks(const uint8_t *p, size_t len, Block_Masks *m){
+    size_t full = len / 64;
+    size_t rest = len % 64;
+
+    build_masks(p, full, m, 0);
+
+    if (rest != 0){
+        uint8_t pad[64] = {0};
+        memcpy(pad, p + full * 64, rest);
+        build_masks(pad, 1, m, full);
+    }
+}
+
+//This function returns the position of the next set bit in [from, to), or to if none
+static size_t next_bit(const uint64_t *mask, size_t from, size_t to){
+    while (from < to){
+        size_t b = from / 64;
+        uint64_t bits = mask[b] & (~(uint64_t)0 << (from % 64));
+
+        if (bits != 0){
+            size_t pos = b * 64 + (size_t)__builtin_ctzll(bits);
+            return (pos < to) ? pos : to;
+        }
+        from = (b + 1) * 64;
+    }
+
+    return to;
+}
+
+//This function XORs a run of bytes 16 at a time, for the NMEA checksum
+static uint8_t xor_bytes(const uint8_t *p, size_t n){
+    uint8_t x = 0;
+
+#ifdef __SSE2__
+    __m128i acc = _mm_setzero_si128();
+    while (n >= 16){
+        acc = _mm_xor_si128(acc, _mm_loadu_si128((const __m128i *)p));
+        p += 16;
+        n -= 16;
+    }
+    acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 8));
+    acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 4));
+    acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 2));
+    acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 1));
+    x = (uint8_t)_mm_cvtsi128_si32(acc);
+#endif
+
+    while (n--) x ^= *p++;
+
+    return x;
+}
+
+/* RECORD FUNCTIONS
+ *
+ * The following functions turn lines into flight-log records. It consists of the following:
+ * [1] Output Append
+ * [2] Number Parsing (bounded, the capture is not NUL terminated)
+ * [3] GGA Conversion
+ * [4] Report Line Handling
+ */
+
+static void out_append(Out_Buffer *out, const char *data, size_t len){
+    if (out->len + len > out->cap){
+        size_t cap = out->cap ? out->cap * 2 : (1 << 20);
+        while (cap < out->len + len) cap *= 2;
+        out->data = realloc(out->data, cap);
+        if (out->data == NULL){
+            perror("realloc");
+            exit(1);
+        }
+        out->cap = cap;
+    }
+
+    memcpy(out->data + out->len, data, len);
+    out->len += len;
+}
+
+//This function parses a decimal number in [p, end), returns false if there is none
+static bool parse_number(const char *p, const char *end, double *value){
+    bool neg = false, digits = false;
+    double v = 0.0, scale = 1.0;
+
+    while (p < end && *p == ' ') p++;
+    if (p < end && (*p == '-' || *p == '+')) neg = (*p++ == '-');
+
+    while (p < end && *p >= '0' && *p <= '9'){
+        v = v * 10.0 + (*p++ - '0');
+        digits = true;
+    }
+    if (p < end && *p == '.'){
+        p++;
+        while (p < end && *p >= '0' && *p <= '9'){
+            scale *= 0.1;
+            v += (*p++ - '0') * scale;
+            digits = true;
+        }
+    }
+
+    *value = neg ? -v : v;
+    return digits;
+}
+
+//This function converts NMEA ddmm.mmmm to decimal degrees
+static double nmea_to_degrees(double nmea, char hemisphere){
+    double deg = floor(nmea / 100);
+    double value = deg + (nmea - deg * 100) / 60;
+    return (hemisphere == 'S' || hemisphere == 'W') ? -value : value;
+}
+
+/* Record formatting, snprintf("%f") costs more than the whole scan so the
+ * fields are written by hand. put_fixed() rounds to the given decimals.
+ */
+static char *put_str(char *p, const char *str){
+    while (*str) *p++ = *str++;
+    return p;
+}
+
+static char *put_uint(char *p, uint64_t v, int min_digits){
+    char digits[24];
+    int n = 0;
+
+    do {
+        digits[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v != 0 || n < min_digits);
+
+    while (n) *p++ = digits[--n];
+    return p;
+}
+
+static char *put_fixed(char *p, double v, int decimals){
+    static const double scale[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8 };
+    uint64_t one = (uint64_t)scale[decimals];
+
+    if (v < 0){
+        *p++ = '-';
+        v = -v;
+    }
+
+    uint64_t scaled = (uint64_t)llround(v * scale[decimals]);
+    p = put_uint(p, scaled / one, 1);
+    *p++ = '.';
+    return put_uint(p, scaled % one, decimals);
+}
+
+//This function writes ",<value>" or just "," when the value is missing
+static char *put_field(char *p, bool present, double v, int decimals){
+    *p++ = ',';
+    return present ? put_fixed(p, v, decimals) : p;
+}
+
+//This function converts a checksummed GGA sentence to a flight-log record
+static void convert_gga(Chunk_Job *job, const char *line, const size_t *fields, int nfields, const char *line_end){
+    double t, lat = 0, lon = 0, alt = 0, fix, sats;
+    char record[192];
+    char *p = record;
+
+    //Field k runs from after comma k-1 to comma k (or the '*')
+    #define FIELD(k) (line + fields[(k) - 1] + 1)
+    #define FIELD_END(k) ((k) < nfields ? line + fields[(k)] : line_end)
+
+    if (nfields < 10) return;
+    if (!parse_number(FIELD(1), FIELD_END(1), &t)) return;
+    job->stats.gga++;
+
+    bool has_pos = parse_number(FIELD(2), FIELD_END(2), &lat) && parse_number(FIELD(4), FIELD_END(4), &lon);
+    bool has_alt = parse_number(FIELD(9), FIELD_END(9), &alt);
+    if (!parse_number(FIELD(6), FIELD_END(6), &fix)) fix = 0;
+    if (!parse_number(FIELD(7), FIELD_END(7), &sats)) sats = 0;
+
+    //Local Time the same way the transmitter computes it
+    int time = (int)t;
+    time = (time > 160000) ? (time + LOCAL_UTC_OFFSET - 240000) : (time + LOCAL_UTC_OFFSET);
+
+    p = put_str(p, "gga,,");
+    p = put_uint(p, (uint64_t)(time / 10000), 2);
+    *p++ = ':';
+    p = put_uint(p, (uint64_t)((time % 10000) / 100), 2);
+    *p++ = ':';
+    p = put_uint(p, (uint64_t)(time % 100), 2);
+    p = put_field(p, has_pos, nmea_to_degrees(lat, *FIELD(3)), 6);
+    p = put_field(p, has_pos, nmea_to_degrees(lon, *FIELD(5)), 6);
+    p = put_field(p, has_alt, alt, 2);
+    *p++ = ',';
+    p = put_uint(p, (uint64_t)fix, 1);
+    *p++ = ',';
+    p = put_uint(p, (uint64_t)sats, 1);
+    p = put_str(p, ",,,,,,\n");
+
+    out_append(&job->out, record, (size_t)(p - record));
+
+    #undef FIELD
+    #undef FIELD_END
+}
+
+//This function writes out the report collected so far
+static void report_flush(Chunk_Job *job){
+    Report *r = &job->report;
+    char record[256];
+    char *p = record;
+
+    if (!r->open) return;
+
+    r->open = false;
+    job->stats.reports++;
+
+    p = put_str(p, "report,");
+    if (r->seq >= 0) p = put_uint(p, (uint64_t)r->seq, 1);
+    *p++ = ',';
+    p = put_str(p, r->time);
+    p = put_field(p, r->has_pos, r->lat, 6);
+    p = put_field(p, r->has_pos, r->lon, 6);
+    p = put_field(p, r->has_alt, r->alt, 2);
+    p = put_str(p, ",,");
+    p = put_field(p, r->has_co2, r->co2, 3);
+    p = put_field(p, r->has_temp, r->temp, 3);
+    p = put_field(p, r->has_humid, r->humid, 2);
+    p = put_field(p, r->has_pm, r->pm, 8);
+    p = put_field(p, r->has_pressure, r->pressure, 2);
+    p = put_field(p, r->has_baro_alt, r->baro_alt, 2);
+    *p++ = '\n';
+
+    out_append(&job->out, record, (size_t)(p - record));
+}
+
+//This function returns true if the line starts with the given prefix
+static bool starts_with(const char *line, const char *end, const char *prefix){
+    size_t n = strlen(prefix);
+    return (size_t)(end - line) >= n && memcmp(line, prefix, n) == 0;
+}
+
+//This function handles one line of the transmitter's ASCII report format
+static void handle_report_line(Chunk_Job *job, const char *line, const char *end){
+    Report *r = &job->report;
+    double v;
+
+    //Receiver record header: #F,<seq>,<len> or #R,<seq>,<len>
+    if (starts_with(line, end, "#F,") || starts_with(line, end, "#R,")){
+        job->pending_seq = parse_number(line + 3, end, &v) ? (long)v : -1;
+        return;
+    }
+
+    if (starts_with(line, end, REPORT_HEADER)){
+        report_flush(job);
+        memset(r, 0, sizeof(*r));
+        r->open = true;
+        r->seq = job->pending_seq;
+        job->pending_seq = -1;
+        return;
+    }
+
+    if (!r->open) return;
+
+    if (starts_with(line, end, "C02 Readings: ")){
+        r->has_co2 = parse_number(line + 14, end, &r->co2);
+    } else if (starts_with(line, end, "Temperature Readings: ")){
+        r->has_temp = parse_number(line + 22, end, &r->temp);
+    } else if (starts_with(line, end, "Humidity Reading: ")){
+        r->has_humid = parse_number(line + 18, end, &r->humid);
+    } else if (starts_with(line, end, "Pressure: ")){
+        r->has_pressure = parse_number(line + 10, end, &r->pressure);
+    } else if (starts_with(line, end, "Baro Altitude: ")){
+        r->has_baro_alt = parse_number(line + 15, end, &r->baro_alt);
+    } else if (starts_with(line, end, "PM Readings: ")){
+        r->has_pm = parse_number(line + 13, end, &r->pm);
+    } else if (starts_with(line, end, "Altitude: ")){
+        r->has_alt = parse_number(line + 10, end, &r->alt);
+    } else if (starts_with(line, end, "Local Time: ")){
+        size_t n = (size_t)(end - (line + 12));
+        if (n >= sizeof(r->time)) n = sizeof(r->time) - 1;
+        memcpy(r->time, line + 12, n);
+        r->time[n] = '\0';
+    } else if (starts_with(line, end, "GMaps: ")){
+        const char *comma = memchr(line, ',', (size_t)(end - line));
+        r->has_pos = comma && parse_number(line + 7, comma, &r->lat) && parse_number(comma + 1, end, &r->lon);
+    }
+}
+
+static int hex_value(uint8_t c){
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+//This function handles one line, offsets are relative to the window base
+static void handle_line(Chunk_Job *job, const uint8_t *base, size_t start, size_t end){
+    const char *line = (const char *)base + start;
+
+    //Strip the CR of CRLF captures
+    if (end > start && base[end - 1] == '\r') end--;
+
+    //A report ends at its blank line, so records come out in the same
+    //order however the capture was split between threads
+    if (end == start){
+        report_flush(job);
+        return;
+    }
+
+    job->stats.lines++;
+
+    //NMEA sentence: $<talker><type>,<fields>*<hex checksum>
+    if ((job->masks.dollar[start / 64] >> (start % 64)) & 1){
+        job->stats.sentences++;
+        report_flush(job);
+
+        size_t star = next_bit(job->masks.star, start, end);
+        if (star + 3 > end){
+            job->stats.checksum_bad++;
+            return;
+        }
+
+        int hi = hex_value(base[star + 1]), lo = hex_value(base[star + 2]);
+        if (hi < 0 || lo < 0 || xor_bytes(base + start + 1, star - start - 1) != (uint8_t)((hi << 4) | lo)){
+            job->stats.checksum_bad++;
+            return;
+        }
+        job->stats.checksum_ok++;
+
+        if (star - start < 6 || memcmp(line + 3, "GGA", 3) != 0) return;
+
+        //Comma offsets straight from the comma mask
+        size_t fields[MAX_NMEA_FIELDS];
+        int nfields = 0;
+        size_t pos = start;
+        while (nfields < MAX_NMEA_FIELDS && (pos = next_bit(job->masks.comma, pos, star)) < star){
+            fields[nfields++] = pos - start;
+            pos++;
+        }
+
+        convert_gga(job, line, fields, nfields, (const char *)base + star);
+        return;
+    }
+
+    handle_report_line(job, line, (const char *)base + end);
+}
+
+/* CHUNK FUNCTIONS
+ *
+ * The following functions split the capture and process it on threads. It consists of the following:
+ * [1] Chunk Worker
+ * [2] Chunk Split
+ */
+
+static void *chunk_worker(void *arg){
+    Chunk_Job *job = arg;
+    const uint8_t *ws = job->begin;
+    bool skip_first = false;
+
+    job->pending_seq = -1;
+
+    while (ws < job->end){
+        size_t len = (size_t)(job->end - ws);
+        if (len > WINDOW_SIZE) len = WINDOW_SIZE;
+        bool last = (ws + len == job->end);
+
+        build_window_masks(ws, len, &job->masks);
+
+        //Walk the newline mask, each hit closes a line
+        size_t line_start = 0;
+        size_t nl;
+        while ((nl = next_bit(job->masks.nl, line_start, len)) < len){
+            if (!skip_first) handle_line(job, ws, line_start, nl);
+            skip_first = false;
+            line_start = nl + 1;
+        }
+
+        if (last){
+            if (line_start < len && !skip_first) handle_line(job, ws, line_start, len);
+            break;
+        }
+
+        //Benchmark passes convert every record too, only the keeping is skipped
+        if (!job->emit) job->out.len = 0;
+
+        //Carry the unfinished line into the next window, a line longer than
+        //a whole window is garbage and is skipped up to its newline
+        if (line_start == 0){
+            skip_first = true;
+            ws += len;
+        } else {
+            ws += line_start;
+        }
+    }
+
+    report_flush(job);
+    job->stats.bytes = (uint64_t)(job->end - job->begin);
+
+    return NULL;
+}
+
+//This function moves a split point to the start of the next record line
+static const uint8_t *align_split(const uint8_t *p, const uint8_t *end){
+    while (p < end){
+        const uint8_t *nl = memchr(p, '\n', (size_t)(end - p));
+        if (nl == NULL) return end;
+        p = nl + 1;
+        //Never before a report header, its #F/#R line would stay behind
+        if (p < end && (*p == '$' || *p == '#')) return p;
+    }
+
+    return end;
+}
+
+//This function processes one mapped capture on the given number of threads
+static void process_capture(const uint8_t *data, size_t size, int threads, bool emit, FILE *out, Scan_Stats *total){
+    Chunk_Job *jobs = calloc((size_t)threads, sizeof(Chunk_Job));
+    pthread_t *tids = calloc((size_t)threads, sizeof(pthread_t));
+    const uint8_t *end = data + size;
+    const uint8_t *p = data;
+
+    if (jobs == NULL || tids == NULL){
+        perror("calloc");
+        exit(1);
+    }
+
+    for (int i = 0; i < threads; i++){
+        const uint8_t *split = (i == threads - 1) ? end : align_split(data + size / threads * (i + 1), end);
+        if (split < p) split = p;
+
+        jobs[i].begin = p;
+        jobs[i].end = split;
+        jobs[i].emit = emit;
+        p = split;
+
+        pthread_create(&tids[i], NULL, chunk_worker, &jobs[i]);
+    }
+
+    for (int i = 0; i < threads; i++){
+        pthread_join(tids[i], NULL);
+
+        if (emit && out != NULL) fwrite(jobs[i].out.data, 1, jobs[i].out.len, out);
+        free(jobs[i].out.data);
+
+        total->bytes += jobs[i].stats.bytes;
+        total->lines += jobs[i].stats.lines;
+        total->sentences += jobs[i].stats.sentences;
+        total->checksum_ok += jobs[i].stats.checksum_ok;
+        total->checksum_bad += jobs[i].stats.checksum_bad;
+        total->gga += jobs[i].stats.gga;
+        total->reports += jobs[i].stats.reports;
+    }
+
+    free(tids);
+    free(jobs);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+//This function appends an NMEA sentence with its checksum
+static int synth_sentence(char *buf, const char *body){
+    uint8_t x = 0;
+    for (const char *p = body; *p; p++) x ^= (uint8_t)*p;
+    return sprintf(buf, "$%s*%02X\r\n", body, x);
+}
+
+//This function writes a synthetic capture of roughly mb megabytes for benchmarking
+static int write_synthetic(const char *path, long mb){
+    FILE *f = fopen(path, "wb");
+    if (f == NULL){
+        perror(path);
+        return 1;
+    }
+
+    srand(1);
+    long target = mb * 1024 * 1024, written = 0, seq = 0;
+    char body[128], buf[512];
+
+    while (written < target){
+        int s = (int)(seq % 86400);
+        int hhmmss = (s / 3600) * 10000 + ((s / 60) % 60) * 100 + s % 60;
+        int n = 0;
+
+        snprintf(body, sizeof(body), "GPGGA,%06d.00,1439.%04d,N,12103.%04d,E,1,08,0.9,%d.%d,M,46.9,M,,",
+                 hhmmss, rand() % 10000, rand() % 10000, 100 + rand() % 900, rand() % 10);
+        n += synth_sentence(buf + n, body);
+        snprintf(body, sizeof(body), "GPRMC,%06d.00,A,1439.%04d,N,12103.%04d,E,0.5,54.7,181026,,,A",
+                 hhmmss, rand() % 10000, rand() % 10000);
+        n += synth_sentence(buf + n, body);
+        n += synth_sentence(buf + n, "GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00");
+
+        //About 1 in 100 sentences arrives corrupted
+        if (rand() % 33 == 0) buf[10] ^= 0x01;
+
+        n += sprintf(buf + n, "#F,%ld,180\r\n" REPORT_HEADER "\r\nC02 Readings: %.3f PPM\r\n"
+                     "Temperature Readings: %.3f  C\r\nHumidity Reading: %.2f %%\r\n"
+                     "Pressure: %.2f hPa\r\nBaro Altitude: %.2f m\r\nPM Readings: %.8f mg/m^3\r\nLocal Time: 12:%02d:%02d\r\nAltitude: %.2f m\r\n"
+                     "GMaps: 14.650000, 121.050000\r\n\r\n",
+                     seq & 0xFFFF, 400 + rand() % 200 / 1.0, 25 + rand() % 100 / 10.0,
+                     60 + rand() % 300 / 10.0, 900 + rand() % 10000 / 100.0, 500 + rand() % 10000 / 10.0,
+                     rand() % 1000 / 1e5, (s / 60) % 60, s % 60, rand() % 1000 / 10.0);
+
+        fwrite(buf, 1, (size_t)n, f);
+        written += n;
+        seq++;
+    }
+
+    fclose(f);
+    return 0;
+}
+
+//This function converts a capture into a CSV in memory
+static char *capture_csv(const uint8_t *data, size_t size, int threads, size_t *len){
+    Scan_Stats stats = {0};
+    char *csv = NULL;
+    FILE *m = open_memstream(&csv, len);
+
+    if (m == NULL){
+        perror("open_memstream");
+        exit(1);
+    }
+
+    process_capture(data, size, threads, true, m, &stats);
+    fclose(m);
+    return csv;
+}
+
+//This function checks that every thread count from 2 to max gives the single-thread CSV
+static bool check_split(const char *path, const uint8_t *data, size_t size, int max_threads){
+    size_t ref_len, len;
+    char *ref = capture_csv(data, size, 1, &ref_len);
+    bool ok = true;
+
+    for (int t = 2; t <= max_threads; t++){
+        char *csv = capture_csv(data, size, t, &len);
+
+        if (len != ref_len || memcmp(csv, ref, len) != 0){
+            fprintf(stderr, "%s: CSV on %d threads differs from 1 thread\n", path, t);
+            ok = false;
+        }
+        free(csv);
+    }
+
+    free(ref);
+    return ok;
+}
+
+static double now_seconds(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void usage(const char *prog){
+    fprintf(stderr, "usage: %s [-t threads] [-o out.csv] [-r passes] [-m avx2|sse2|scalar] capture...\n"
+                    "       %s -S <MB> synth.txt\n"
+                    "       %s -c -t <max threads> capture...\n", prog, prog, prog);
+}
+
+// main() -- the heart of the program
+int main(int argc, char **argv){
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int passes = 1;
+    const char *out_path = NULL;
+    const char *simd_limit = NULL;
+    bool check = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:o:r:m:S:ch")) != -1){
+        switch (opt){
+        case 'm': simd_limit = optarg; break;
+        case 't': threads = atoi(optarg); break;
+        case 'o': out_path = optarg; break;
+        case 'r': passes = atoi(optarg); break;
+        case 'c': check = true; break;
+        case 'S':
+            if (optind >= argc){
+                usage(argv[0]);
+                return 2;
+            }
+            return write_synthetic(argv[optind], atol(optarg));
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (optind >= argc || threads < 1 || passes < 1){
+        usage(argv[0]);
+        return 2;
+    }
+
+    select_simd(simd_limit);
+
+    FILE *out = NULL;
+    if (out_path != NULL){
+        out = fopen(out_path, "w");
+        if (out == NULL){
+            perror(out_path);
+            return 1;
+        }
+        fputs("source,seq,local_time,lat,lon,alt_m,fix,sats,co2_ppm,temp_c,humidity_pct,pm_mg_m3,pressure_hpa,baro_alt_m\n", out);
+    }
+
+    Scan_Stats total = {0};
+    bool failed = false;
+    uint64_t bytes_scanned = 0, sentences_scanned = 0;
+    double elapsed = 0.0;
+
+    for (int i = optind; i < argc; i++){
+        int fd = open(argv[i], O_RDONLY);
+        struct stat st;
+
+        if (fd < 0 || fstat(fd, &st) != 0){
+            perror(argv[i]);
+            return 1;
+        }
+        if (st.st_size == 0){
+            close(fd);
+            continue;
+        }
+
+        const uint8_t *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED){
+            perror("mmap");
+            return 1;
+        }
+        madvise((void *)data, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+        if (check){
+            if (!check_split(argv[i], data, (size_t)st.st_size, threads)) failed = true;
+            munmap((void *)data, (size_t)st.st_size);
+            close(fd);
+            continue;
+        }
+
+        //Every pass converts and is timed, only the first one writes records and counts them
+        for (int pass = 0; pass < passes; pass++){
+            Scan_Stats stats = {0};
+            double t0 = now_seconds();
+
+            process_capture(data, (size_t)st.st_size, threads, pass == 0 && out != NULL, out,
+                            (pass == 0) ? &total : &stats);
+
+            elapsed += now_seconds() - t0;
+            bytes_scanned += (uint64_t)st.st_size;
+            sentences_scanned += (pass == 0) ? 0 : stats.sentences;
+        }
+
+        munmap((void *)data, (size_t)st.st_size);
+        close(fd);
+    }
+
+    if (out != NULL) fclose(out);
+
+    if (check){
+        fprintf(stderr, "simd=%s split check on 1..%d threads: %s\n", simd_name, threads, failed ? "FAILED" : "ok");
+        return failed ? 1 : 0;
+    }
+
+    sentences_scanned += total.sentences;
+
+    fprintf(stderr, "simd=%s threads=%d passes=%d\n", simd_name, threads, passes);
+    fprintf(stderr, "lines=%llu sentences=%llu checksum_ok=%llu checksum_bad=%llu gga=%llu reports=%llu\n",
+            (unsigned long long)total.lines, (unsigned long long)total.sentences,
+            (unsigned long long)total.checksum_ok, (unsigned long long)total.checksum_bad,
+            (unsigned long long)total.gga, (unsigned long long)total.reports);
+    fprintf(stderr, "elapsed=%.3f s  throughput=%.2f GB/s  %.2f M sentences/s\n",
+            elapsed, bytes_scanned / elapsed / 1e9, sentences_scanned / elapsed / 1e6);
+
+    return 0;
+}
@@ -0,0 +1,415 @@
+/*
+ * File:   receiver_main.c
+ * Author: MSI
+ *
+ * Created on October 18, 2026
+ */
+
+#include <xc.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+//Frame format shared with the transmitter
+#include "hc12_frame.h"
+
+//Import function from "receiver_init.c"
+extern void Program_Initialize(void);
+extern uint32_t time_now_ms(void);
+
+//HC12 RX Ring Buffer (must be a power of two)
+#define RX_RING_SIZE 1024
+#define RX_RING_MASK (RX_RING_SIZE - 1)
+
+//Host TX Queue (must be a power of two)
+#define HOST_QUEUE_SIZE 2048
+#define HOST_QUEUE_MASK (HOST_QUEUE_SIZE - 1)
+
+//DMA Settings for the Host UART
+#define HOST_DMA_CHANNEL 0
+#define HOST_DMA_TRIGSRC 0x0B // SERCOM3 TX
+
+//Print a statistics line after this many frames
+#define STATS_INTERVAL 32
+
+//Gap tracking for the NACK uplink
+#define MISSING_MAX 16
+#define NACK_MAX_TRIES 3
+#define SEQ_RESTART_WINDOW 256
+
+// Structure of a DMAC transfer descriptor
+typedef struct {
+    uint16_t btctrl;
+    uint16_t btcnt;
+    uint32_t srcaddr;
+    uint32_t dstaddr;
+    uint32_t descaddr;
+} DMAC_Descriptor;
+
+//DMAC descriptor and write-back memory (must be 128-bit aligned)
+static DMAC_Descriptor dma_descriptor __attribute__((aligned(16)));
+static DMAC_Descriptor dma_writeback __attribute__((aligned(16)));
+
+//HC12 RX Ring Buffer, written by the RXC interrupt only
+static volatile uint8_t rx_ring[RX_RING_SIZE];
+static volatile uint16_t rx_head = 0;
+static volatile uint16_t rx_tail = 0;
+static volatile uint32_t rx_overflows = 0;
+static volatile uint32_t rx_line_errors = 0;
+
+//Host TX Queue, head is moved by the main loop and tail by the DMA interrupt
+static uint8_t host_queue[HOST_QUEUE_SIZE];
+static volatile uint16_t host_head = 0;
+static volatile uint16_t host_tail = 0;
+static volatile uint16_t host_dma_len = 0;
+static volatile uint32_t host_stalls = 0;
+
+//Frame Parser
+static HC12_Parser parser;
+
+// Structure to hold a sequence number the ground station is still waiting for
+typedef struct {
+    uint16_t seq;
+    uint8_t tries;
+} Missing_Frame;
+
+//Gap tracking, oldest missing frame first
+static Missing_Frame missing[MISSING_MAX];
+static uint8_t missing_count = 0;
+static bool seq_synced = false;
+static uint16_t next_seq = 0;
+static uint32_t frames_recovered = 0;
+static uint32_t frames_lost = 0;
+
+/////////////////////////////////////////////////////////////////////////////
+
+ /* HC12 MODULE FUNCTIONS
+ *
+ * The following functions are used for receiving data from the module. It consists of the following:
+ * [1] HC12 RX Interrupt Handler
+ * [2] HC12 Read Byte
+ * [3] HC12 Send NACK
+ */
+
+//This interrupt pushes every received byte into the ring buffer
+void SERCOM0_2_Handler(void){
+    //Frame, parity or buffer overflow errors
+    uint16_t status = SERCOM0_REGS->USART_INT.SERCOM_STATUS;
+    if (status & 0x07){
+        SERCOM0_REGS->USART_INT.SERCOM_STATUS = status & 0x07;
+        rx_line_errors++;
+    }
+
+    //Reading DATA also clears RXC
+    uint8_t data = SERCOM0_REGS->USART_INT.SERCOM_DATA;
+    uint16_t next = (rx_head + 1) & RX_RING_MASK;
+
+    if (next == rx_tail){
+        rx_overflows++;
+        return;
+    }
+
+    rx_ring[rx_head] = data;
+    rx_head = next;
+}
+
+//This function takes one byte from the ring buffer, returns false if it is empty
+static bool hc12_read_byte(uint8_t *data){
+    if (rx_tail == rx_head) return false;
+
+    *data = rx_ring[rx_tail];
+    rx_tail = (rx_tail + 1) & RX_RING_MASK;
+
+    return true;
+}
+
+//This function asks the transmitter to resend a run of missing frames
+static void hc12_send_nack(uint16_t first, uint8_t count){
+    uint8_t payload[HC12_NACK_LEN];
+    uint8_t frame[HC12_HEADER_LEN + HC12_NACK_LEN + HC12_CRC_LEN];
+
+    payload[0] = (uint8_t)(first & 0xFF);
+    payload[1] = (uint8_t)(first >> 8);
+    payload[2] = count;
+
+    uint32_t len = hc12_frame_encode(HC12_TYPE_NACK, 0, payload, HC12_NACK_LEN, frame);
+
+    // TX Handling
+    for (uint32_t i = 0; i < len; i++){
+        while (!(SERCOM0_REGS->USART_INT.SERCOM_INTFLAG & (1 << 0)));
+        SERCOM0_REGS->USART_INT.SERCOM_DATA = frame[i];
+    }
+}
+
+/* HOST UART FUNCTIONS
+ *
+ * The following functions are used for forwarding data to the host. It consists of the following:
+ * [1] DMAC Initialize Function
+ * [2] Host DMA Kick
+ * [3] Host DMA Interrupt Handler
+ * [4] Host Write
+ */
+
+//This function is for DMAC Initialization
+void DMAC_Initialize(void){
+    //Reset the DMAC
+    DMAC_REGS->DMAC_CTRL = (1 << 0);
+    while (DMAC_REGS->DMAC_CTRL & (1 << 0));
+
+    //Descriptor and Write-Back Memory
+    DMAC_REGS->DMAC_BASEADDR = (uint32_t)&dma_descriptor;
+    DMAC_REGS->DMAC_WRBADDR = (uint32_t)&dma_writeback;
+
+    //Host TX Channel : Beat Trigger on SERCOM3 TX | Priority Level 0
+    DMAC_REGS->DMAC_CHID = HOST_DMA_CHANNEL;
+    DMAC_REGS->DMAC_CHCTRLA = (1 << 0);
+    while (DMAC_REGS->DMAC_CHCTRLA & (1 << 0));
+    DMAC_REGS->DMAC_CHCTRLB = (2 << 22) | (HOST_DMA_TRIGSRC << 8) | (0 << 5);
+
+    //Transfer Complete interrupt
+    DMAC_REGS->DMAC_CHINTENSET = (1 << 1);
+
+    //DMAC Enable with Priority Level 0 Enabled
+    DMAC_REGS->DMAC_CTRL = (1 << 1) | (1 << 8);
+
+    //Exit
+    return;
+}
+
+//This function starts a DMA transfer of the next contiguous chunk of the queue
+static void host_dma_kick(void){
+    if (host_dma_len != 0 || host_tail == host_head) return;
+
+    //Send up to the queue head or the end of the buffer, whichever comes first
+    uint16_t len = (host_head > host_tail) ? (host_head - host_tail) : (HOST_QUEUE_SIZE - host_tail);
+    host_dma_len = len;
+
+    //Valid | Byte Beats | Source Increment, the source address is the end of the block
+    dma_descriptor.btctrl = (1 << 0) | (0 << 8) | (1 << 10);
+    dma_descriptor.btcnt = len;
+    dma_descriptor.srcaddr = (uint32_t)&host_queue[host_tail + len];
+    dma_descriptor.dstaddr = (uint32_t)&SERCOM3_REGS->USART_INT.SERCOM_DATA;
+    dma_descriptor.descaddr = 0;
+
+    DMAC_REGS->DMAC_CHID = HOST_DMA_CHANNEL;
+    DMAC_REGS->DMAC_CHCTRLA |= (1 << 1);
+}
+
+//This interrupt releases the chunk that was just sent and starts the next one
+void DMAC_0_Handler(void){
+    DMAC_REGS->DMAC_CHID = HOST_DMA_CHANNEL;
+    DMAC_REGS->DMAC_CHINTFLAG = (1 << 1) | (1 << 0);
+
+    host_tail = (host_tail + host_dma_len) & HOST_QUEUE_MASK;
+    host_dma_len = 0;
+
+    host_dma_kick();
+}
+
+//This function returns the free space in the host queue, one slot stays empty
+static uint16_t host_space(void){
+    return (uint16_t)((host_tail - host_head - 1) & HOST_QUEUE_MASK);
+}
+
+//This function is used to queue data for the host
+static void host_write(const uint8_t *data, uint16_t len){
+    //The host link is much faster than the radio, so waiting for room only
+    //happens on bursts and the RX ring keeps filling in the meantime
+    if (host_space() < len){
+        //Count the blocked call once, not every spin
+        host_stalls++;
+        while (host_space() < len);
+    }
+
+    for (uint16_t i = 0; i < len; i++){
+        host_queue[host_head] = data[i];
+        host_head = (host_head + 1) & HOST_QUEUE_MASK;
+    }
+
+    //Kick the DMA, the interrupt must not run in the middle of it
+    __disable_irq();
+    host_dma_kick();
+    __enable_irq();
+}
+
+static void host_print(const char *message){
+    host_write((const uint8_t *)message, strlen(message));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+/* GAP TRACKING FUNCTIONS
+ *
+ * The following functions keep track of the sequence numbers that never
+ * arrived and request them again. It consists of the following:
+ * [1] Missing Add / Remove
+ * [2] Missing Prune
+ * [3] Request Backfill
+ */
+
+static void missing_drop(uint8_t idx){
+    missing_count--;
+    memmove(&missing[idx], &missing[idx + 1], (missing_count - idx) * sizeof(missing[0]));
+}
+
+static void missing_add(uint16_t seq){
+    //Out of room, give up on the oldest one
+    if (missing_count == MISSING_MAX){
+        missing_drop(0);
+        frames_lost++;
+    }
+
+    missing[missing_count].seq = seq;
+    missing[missing_count].tries = 0;
+    missing_count++;
+}
+
+//This function returns true if the sequence number was still missing
+static bool missing_remove(uint16_t seq){
+    for (uint8_t i = 0; i < missing_count; i++){
+        if (missing[i].seq == seq){
+            missing_drop(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//This function forgets frames the transmitter no longer has or that were asked for too often
+static void missing_prune(void){
+    uint8_t i = 0;
+
+    while (i < missing_count){
+        uint16_t age = (uint16_t)(next_seq - missing[i].seq);
+
+        if (age > HC12_HISTORY_DEPTH || missing[i].tries >= NACK_MAX_TRIES){
+            missing_drop(i);
+            frames_lost++;
+            continue;
+        }
+        i++;
+    }
+}
+
+//This function sends one NACK for the oldest run of missing frames
+static void request_backfill(void){
+    missing_prune();
+
+    if (missing_count == 0) return;
+
+    //Extend the run while the sequence numbers are consecutive
+    uint16_t first = missing[0].seq;
+    uint8_t count = 1;
+    while (count < missing_count && missing[count].seq == (uint16_t)(first + count)){
+        count++;
+    }
+
+    for (uint8_t i = 0; i < count; i++){
+        missing[i].tries++;
+    }
+
+    hc12_send_nack(first, count);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+//This function forwards a decoded frame to the host
+static void forward_frame(const HC12_Frame *frame, bool backfilled, uint32_t rx_ms){
+    char header[96];
+    HC12_Trace trace;
+    uint16_t report_len = frame->len - HC12_TRACE_LEN;
+
+    //Trace stamps of live frames, backfilled ones are too late to say anything about latency
+    if (!backfilled){
+        hc12_trace_get(frame->payload, &trace);
+        snprintf(header, sizeof(header), "#T,%u,%u,%lu,%lu,%lu,%lu,%lu\r\n", frame->seq, frame->len,
+                 (unsigned long)trace.acquire_ms, (unsigned long)trace.ready_ms,
+                 (unsigned long)trace.tx_start_ms, (unsigned long)trace.prev_tx_end_ms,
+                 (unsigned long)rx_ms);
+        host_print(header);
+    }
+
+    //Record header followed by the report exactly as the transmitter built it
+    snprintf(header, sizeof(header), "#%c,%u,%u\r\n", backfilled ? 'R' : 'F', frame->seq, report_len);
+    host_print(header);
+    host_write(&frame->payload[HC12_TRACE_LEN], report_len);
+
+    //Link statistics
+    if ((parser.frames % STATS_INTERVAL) == 0){
+        char stats[128];
+        snprintf(stats, sizeof(stats), "#S,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\r\n",
+                 (unsigned long)parser.frames, (unsigned long)parser.crc_errors,
+                 (unsigned long)parser.resyncs, (unsigned long)rx_overflows,
+                 (unsigned long)rx_line_errors, (unsigned long)host_stalls,
+                 (unsigned long)frames_recovered, (unsigned long)frames_lost);
+        host_print(stats);
+    }
+}
+
+//This function sorts a frame into live, backfilled or duplicate
+static void handle_frame(const HC12_Frame *frame, uint32_t rx_ms){
+    if (frame->type != HC12_TYPE_TELEMETRY || frame->len < HC12_TRACE_LEN) return;
+
+    int16_t ahead = (int16_t)(frame->seq - next_seq);
+
+    //First frame, or the transmitter restarted its sequence numbers
+    if (!seq_synced || ahead > SEQ_RESTART_WINDOW || ahead < -SEQ_RESTART_WINDOW){
+        seq_synced = true;
+        missing_count = 0;
+        next_seq = frame->seq + 1;
+        forward_frame(frame, false, rx_ms);
+        return;
+    }
+
+    //Older than expected: a resend we asked for or a duplicate
+    if (ahead < 0){
+        if (missing_remove(frame->seq)){
+            frames_recovered++;
+            forward_frame(frame, true, rx_ms);
+        }
+        return;
+    }
+
+    //Live frame, remember the gap in front of it (only what the transmitter still keeps)
+    if (ahead > HC12_HISTORY_DEPTH){
+        frames_lost += ahead - HC12_HISTORY_DEPTH;
+        next_seq = (uint16_t)(frame->seq - HC12_HISTORY_DEPTH);
+    }
+    while (next_seq != frame->seq){
+        missing_add(next_seq++);
+    }
+    next_seq = frame->seq + 1;
+
+    forward_frame(frame, false, rx_ms);
+
+    //The transmitter is busy with its sensors after a live frame, so the air is free
+    request_backfill();
+}
+
+// main() -- the heart of the program
+int main(void) {
+    uint8_t data;
+
+    //Initialize Function
+    Program_Initialize();
+
+    //DMAC Initialization
+    DMAC_Initialize();
+
+    hc12_parser_reset(&parser);
+
+    host_print("Program Initialize for the Receiver...\r\n");
+
+    for (;;){
+        while (hc12_read_byte(&data)){
+            if (hc12_parser_feed(&parser, data)){
+                //Receive stamp: last byte of the frame taken from the ring
+                handle_frame(&parser.frame, time_now_ms());
+            }
+        }
+    }
+
+    // This line must never be reached
+    return 1;
+}
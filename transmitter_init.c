@@ -10,6 +10,9 @@
 #include <stdbool.h>
 #include <string.h>
 
+//Debug port settings
+#include "debug_log.h"
+
 /////////////////////////////////////////////////////////////////////////////
 
 // Enable higher frequencies for higher performance
@@ -97,9 +100,51 @@ static void EVSYS_init(void){
 int read_count() {
     // Allow read access of COUNT register 
     TC0_REGS->COUNT16.TC_CTRLBSET = ((0x4) << 5);
+    while ((TC0_REGS->COUNT16.TC_SYNCBUSY & ((0x01) << 2))); // Wait for the READSYNC command
     return TC0_REGS->COUNT16.TC_COUNT;// Return back the counter value
 }
 
+/* TIME SERVICE
+ *
+ * TC0 counts at 4 MHz / 1024 = 3906.25 Hz (0.256 ms per tick) and wraps every
+ * CC0 + 1 = 392 ticks (~100 ms). The overflow interrupt counts the wraps, so
+ * the monotonic time is (wraps * 392 + COUNT) * 0.256 ms.
+ */
+#define TC0_PERIOD_TICKS 392
+
+//Number of TC0 wraps since start-up
+static volatile uint32_t tc0_wraps = 0;
+
+//Import function from "transmitter_main.c", queues a BME280 read every wrap (10 Hz)
+extern void bme280_sample_tick(void);
+
+void TC0_Handler(void){
+    TC0_REGS->COUNT16.TC_INTFLAG = (0x01 << 0); // Clear OVF
+    tc0_wraps++;
+    
+    bme280_sample_tick();
+}
+
+//This function returns the milliseconds elapsed since TC0 was started
+uint32_t time_now_ms(void){
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    
+    uint32_t wraps = tc0_wraps;
+    uint32_t count = (uint32_t)read_count();
+    
+    //A wrap that happened while interrupts were off is not counted yet
+    if ((TC0_REGS->COUNT16.TC_INTFLAG & (0x01 << 0)) && count < TC0_PERIOD_TICKS / 2){
+        wraps++;
+    }
+    
+    __set_PRIMASK(primask);
+    
+    //1 tick = 0.256 ms = 32/125 ms, done in 64-bit so ticks * 32 cannot overflow
+    uint64_t ticks = (uint64_t)wraps * TC0_PERIOD_TICKS + count;
+    return (uint32_t)((ticks * 32) / 125);
+}
+
 //Initialize TC0
 void TC0_Initialize(void){
     /* TC0 Bus Clock */
@@ -119,7 +164,10 @@ void TC0_Initialize(void){
     TC0_REGS->COUNT16.TC_WAVE = (0x01); // Match Frequency Operation mode
     
     /* Setting the Top Value */
-    TC0_REGS->COUNT16.TC_CC[0] = 391; // 391 = Set CC0 (Top) value = 100ms
+    TC0_REGS->COUNT16.TC_CC[0] = TC0_PERIOD_TICKS - 1; // 391 = Set CC0 (Top) value = 100ms
+    
+    /* Overflow interrupt drives the time service */
+    TC0_REGS->COUNT16.TC_INTENSET = (0x01 << 0);
     
     TC0_REGS->COUNT16.TC_CTRLA |= ((0x01) << 1); // Enable the TC0 Peripheral
     while ((TC0_REGS->COUNT16.TC_SYNCBUSY & ((0x01) << 1)));
@@ -131,8 +179,25 @@ static void NVIC_init(void)
 	__enable_irq();
 	NVIC_SetPriority(EIC_EXTINT_2_IRQn, 3);
 	NVIC_SetPriority(SysTick_IRQn, 3);
+	NVIC_SetPriority(SERCOM0_2_IRQn, 2);
+	//TC0 queues the BME280 reads, it must not preempt the SERCOM2 I2C handlers
+	NVIC_SetPriority(TC0_IRQn, 2);
+	NVIC_SetPriority(SERCOM2_0_IRQn, 2);
+	NVIC_SetPriority(SERCOM2_1_IRQn, 2);
+	NVIC_SetPriority(SERCOM2_OTHER_IRQn, 2);
+#if DEBUG_LEVEL > LOG_LEVEL_NONE
+	NVIC_SetPriority(SERCOM3_0_IRQn, 3);
+#endif
 	NVIC_EnableIRQ(EIC_EXTINT_2_IRQn);
 	NVIC_EnableIRQ(SysTick_IRQn);
+	NVIC_EnableIRQ(SERCOM0_2_IRQn);
+	NVIC_EnableIRQ(TC0_IRQn);
+	NVIC_EnableIRQ(SERCOM2_0_IRQn);
+	NVIC_EnableIRQ(SERCOM2_1_IRQn);
+	NVIC_EnableIRQ(SERCOM2_OTHER_IRQn);
+#if DEBUG_LEVEL > LOG_LEVEL_NONE
+	NVIC_EnableIRQ(SERCOM3_0_IRQn);
+#endif
 	return;
 }
 
@@ -191,6 +256,9 @@ void SERCOM0_Initialize(void){
 	while ((SERCOM0_REGS->USART_INT.SERCOM_SYNCBUSY & (0x1 << 2)) != 0)
 		asm("nop");
     
+    //Enable the RXC interrupt for the uplink (NACKs from the ground station)
+    SERCOM0_REGS->USART_INT.SERCOM_INTENSET = (0x1 << 2);
+    
     //Enable the peripheral
 	SERCOM0_REGS->USART_INT.SERCOM_CTRLA |= (0x1 << 1);
 	while ((SERCOM0_REGS->USART_INT.SERCOM_SYNCBUSY & (0x1 << 1)) != 0)
@@ -237,7 +305,8 @@ void SERCOM1_Initialize(void){
     return;
 }
 
-//SERCOM3 UART Initialize Function
+#if DEBUG_LEVEL > LOG_LEVEL_NONE
+//SERCOM3 UART Initialize Function (debug port, TX driven by the DRE interrupt in debug_log.c)
 void SERCOM3_Initialize(void){
     //Enable the Clock Peripheral
     GCLK_REGS->GCLK_PCHCTRL[20] = 0x00000042;
@@ -253,8 +322,8 @@ void SERCOM3_Initialize(void){
     //Setting up the USART Settings
     SERCOM3_REGS->USART_INT.SERCOM_CTRLA |= (0x0 << 13)|(0x1 << 30)|(0x0 << 24)|(0x0 << 16)|(0x1 << 20); //Formerly (0x1 << 24)
 	SERCOM3_REGS->USART_INT.SERCOM_CTRLB |= (0x0 << 6) | (0x0 << 0); //Formerly (0x1 << 0)
-    //sercom baud = 65536(1-(16bits*9600bps/4M) = 63020 = 0xF62C 
-    SERCOM3_REGS->USART_INT.SERCOM_BAUD = 0xF62C;
+    //sercom baud = 65536(1-(16bits*DEBUG_BAUD/4M), 115200bps = 35337 = 0x8A09
+    SERCOM3_REGS->USART_INT.SERCOM_BAUD = (uint16_t)(65536.0 * (1.0 - 16.0 * DEBUG_BAUD / 4000000.0));
     
     //Configure the Physical Pins
     PORT_SEC_REGS->GROUP[1].PORT_PINCFG[8] = 0x03; 
@@ -274,6 +343,47 @@ void SERCOM3_Initialize(void){
     //Exit the initialization
     return;
 }
+#endif
+
+//SERCOM2 I2C Master Initialize Function
+void SERCOM2_Initialize(void){
+    //Enable the Clock Peripheral
+    GCLK_REGS->GCLK_PCHCTRL[19] = 0x00000042;
+	while ((GCLK_REGS->GCLK_PCHCTRL[19] & 0x00000040) == 0)
+		asm("nop");
+    
+    //Software Reset Function
+	SERCOM2_REGS->I2CM.SERCOM_CTRLA |= (0x1 << 0);
+	while ((SERCOM2_REGS->I2CM.SERCOM_SYNCBUSY & (0x1 << 0)) != 0)
+		asm("nop");
+    
+    //Setting up the I2C Settings: I2C Master Mode | SDA Hold 300-600ns
+	SERCOM2_REGS->I2CM.SERCOM_CTRLA = (uint32_t)(0x5 << 2) | (0x2 << 20);
+    
+    //sercom baud = 4M/(2*100kHz) - 5 = 15 (Standard Mode)
+    SERCOM2_REGS->I2CM.SERCOM_BAUD = 15;
+    
+    //BME280 Sensor Pinout: PA08 SDA (PAD0), PA09 SCL (PAD1)
+    PORT_SEC_REGS->GROUP[0].PORT_PINCFG[8] = 0x01;
+    PORT_SEC_REGS->GROUP[0].PORT_PINCFG[9] = 0x01;
+    PORT_SEC_REGS->GROUP[0].PORT_PMUX[4] = 0x33;
+    
+    //Master on Bus | Slave on Bus | Error interrupts drive the transaction queue
+    SERCOM2_REGS->I2CM.SERCOM_INTENSET = (0x1 << 0) | (0x1 << 1) | (0x1 << 7);
+    
+    //Enable the peripheral
+	SERCOM2_REGS->I2CM.SERCOM_CTRLA |= (0x1 << 1);
+	while ((SERCOM2_REGS->I2CM.SERCOM_SYNCBUSY & (0x1 << 1)) != 0)
+		asm("nop");
+    
+    //Force the bus state to IDLE
+    SERCOM2_REGS->I2CM.SERCOM_STATUS = (0x1 << 4);
+	while ((SERCOM2_REGS->I2CM.SERCOM_SYNCBUSY & (0x1 << 2)) != 0)
+		asm("nop");
+    
+    //Exit the initialization
+    return;
+}
 
 /////////////////////////////////////////////////////////////////////////////
 
@@ -290,7 +400,10 @@ void Program_Initialize(void){
     ADC_PORT_Initialize();
     SERCOM0_Initialize();
     SERCOM1_Initialize();
+    SERCOM2_Initialize();
+#if DEBUG_LEVEL > LOG_LEVEL_NONE
     SERCOM3_Initialize();
+#endif
     
 	// Late initialization
 	EIC_init_late();
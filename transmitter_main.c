@@ -14,15 +14,36 @@
 #include <stdlib.h>
 #include <math.h>
 
+//Frame format shared with the receiver
+#include "hc12_frame.h"
+
+//Debug log on SERCOM3, compiled out with FLIGHT_BUILD
+#include "debug_log.h"
+
 //Import function from "transmitter_init.c"
 extern void Program_Initialize(void);
+extern uint32_t time_now_ms(void);
 
 //GPS Related Initialization
 #define MAX_GPS_FIELDS 13
 #define MAX_FIELD_LENGTH 20
 
-//Initialize variable for timer
-int time_count = 0;
+//Timeouts, one frame goes out every FRAME_PERIOD_MS even if a peripheral is dead
+#define FRAME_PERIOD_MS 1000
+#define ADC_TIMEOUT_MS 5
+#define UART_BYTE_TIMEOUT_MS 5
+
+//Result of every peripheral wait
+typedef enum {
+    IO_OK = 0,
+    IO_TIMEOUT,     // Nothing happened before the deadline (hung bus, dead peripheral)
+    IO_ERROR        // The peripheral answered with an error (NACK, bus error)
+} IO_Status;
+
+// Structure to hold a point in time after which a wait gives up
+typedef struct {
+    uint32_t expires_ms;
+} Deadline;
 
 // Structure to hold parsed GPS data
 typedef struct {
@@ -45,37 +66,55 @@ typedef struct {
                                // Datasheet typical V_oc (voltage output clean air) is ~0.9V. Use this to adjust offset if needed.
                                // If typical V_oc is 0.9V, offset might be 0.9V. Or this DUST_OFFSET is already adjusted.
 
-#define DEW_POINT 23
-
 /////////////////////////////////////////////////////////////////////////////
 
+/* DEADLINE FUNCTIONS
+ * 
+ * The following functions are used to bound every wait on the TC0 time service. It consists of the following:
+ * [1] Deadline Set
+ * [2] Deadline Expired
+ * [3] Millisecond Delay
+ * [4] Wait Flag
+ */
+
+//This function sets a deadline ms milliseconds from now
+static void deadline_set(Deadline *deadline, uint32_t ms){
+    deadline->expires_ms = time_now_ms() + ms;
+}
+
+//This function checks the deadline, the subtraction keeps it right across the 32-bit wrap
+static bool deadline_expired(const Deadline *deadline){
+    return (int32_t)(time_now_ms() - deadline->expires_ms) >= 0;
+}
+
 //This function will be used for time delay purposes
-static void nsec_delay(int n_delay){
-    time_count = 0;
+static void ms_delay(uint32_t ms){
+    Deadline deadline;
+    deadline_set(&deadline, ms);
     
-    while (1){
-        if(read_count() > TC0_REGS->COUNT16.TC_CC[0]/2){
-            time_count++;
-        }
+    while (!deadline_expired(&deadline));
+}
 
-        if (time_count > n_delay){
-            return;
-        }        
+//This function waits for a flag in a peripheral register or gives up at the deadline
+static IO_Status wait_flag(volatile const uint8_t *reg, uint8_t mask, const Deadline *deadline){
+    while (!(*reg & mask)){
+        if (deadline_expired(deadline)) return IO_TIMEOUT;
     }
+    
+    return IO_OK;
 }
 
-//This function will be used for debugging purposes
-static void print_terminal(const char *message) {
-    if (message == NULL) return;
+//This function sends one byte over a SERCOM USART, giving up if DRE never comes
+static IO_Status uart_write_byte(sercom_registers_t *sercom, uint8_t data){
+    Deadline deadline;
+    deadline_set(&deadline, UART_BYTE_TIMEOUT_MS);
     
-    // TX Handling
-    while (*message) {
-        //Do not send data unless TXC is clear
-        while (!(SERCOM3_REGS->USART_INT.SERCOM_INTFLAG & (1 << 0)));
-        
-        //Send the data
-        SERCOM3_REGS->USART_INT.SERCOM_DATA = *message++;
-    } 
+    if (wait_flag(&sercom->USART_INT.SERCOM_INTFLAG, (1 << 0), &deadline) != IO_OK){
+        return IO_TIMEOUT;
+    }
+    
+    sercom->USART_INT.SERCOM_DATA = data;
+    return IO_OK;
 }
 
  /* GPS MODULE FUNCTIONS
@@ -86,23 +125,37 @@ static void print_terminal(const char *message) {
  * [3] GPS Process Function
  */
 
+//This function reads one character from the GPS, giving up at the deadline
+static IO_Status gps_read_byte(char *data, const Deadline *deadline){
+    //Do not return the character until RXC is set
+    if (wait_flag(&SERCOM1_REGS->USART_INT.SERCOM_INTFLAG, (0x1 << 2), deadline) != IO_OK){
+        return IO_TIMEOUT;
+    }
+    
+    *data = SERCOM1_REGS->USART_INT.SERCOM_DATA;
+    return IO_OK;
+}
+
 // This function is used to GPS read data
-void gps_received_msg(char *buffer, uint32_t len) {
+IO_Status gps_received_msg(char *buffer, uint32_t len, const Deadline *deadline) {
     int idx = 0;
     bool is_gpgga = false;
+    char data;
+    
+    buffer[0] = '\0';
     
     // Read characters until we find the start of a GPRMC message or newline
     while (idx < len - 1) {
-        //Do not return the character until RXC is clear
-        while(!(SERCOM1_REGS->USART_INT.SERCOM_INTFLAG & (0x1 << 2)));
-        
         //Read the data character
-        char data = SERCOM1_REGS->USART_INT.SERCOM_DATA;
+        if (gps_read_byte(&data, deadline) != IO_OK) {
+            buffer[0] = '\0';
+            return IO_TIMEOUT;
+        }
         
         if (data == '\n') {
             if (is_gpgga) {
                 buffer[idx] = '\0'; // Null termination
-                return;
+                return IO_OK;
             }
             idx = 0; // Reset index
             continue;
@@ -113,8 +166,10 @@ void gps_received_msg(char *buffer, uint32_t len) {
             //Checking if it's a GPRMC Message
             char next[5];
             for (int i = 0; i < 5; i++) {
-                while(!(SERCOM1_REGS->USART_INT.SERCOM_INTFLAG & (0x1 << 2)));
-                next[i] = SERCOM1_REGS->USART_INT.SERCOM_DATA;
+                if (gps_read_byte(&next[i], deadline) != IO_OK) {
+                    buffer[0] = '\0';
+                    return IO_TIMEOUT;
+                }
             }
             
             if (strncmp(next, "GPGGA", 5) == 0) {
@@ -145,7 +200,7 @@ void gps_received_msg(char *buffer, uint32_t len) {
     }
     
     //Exit the function
-    return;
+    return IO_OK;
 }
 
 // Function that parses comma-separated GPS data into array
@@ -313,68 +368,720 @@ void ADC_Initialize(void){
     return;
 }
 
-static uint16_t ADC_Read_Channel(uint32_t AIN_Channel){
+static IO_Status ADC_Read_Channel(uint32_t AIN_Channel, uint16_t *result){
+    Deadline deadline;
+    deadline_set(&deadline, ADC_TIMEOUT_MS);
+    
     // Select ADC channel by setting MUXPOS in INPUTCTRL
     ADC_REGS->ADC_INPUTCTRL = AIN_Channel;
-    while (ADC_REGS->ADC_SYNCBUSY & ADC_SYNCBUSY_INPUTCTRL_Msk);
+    while (ADC_REGS->ADC_SYNCBUSY & ADC_SYNCBUSY_INPUTCTRL_Msk) {
+        if (deadline_expired(&deadline)) return IO_TIMEOUT;
+    }
+    
+    // A conversion that finished after an earlier timeout leaves RESRDY set,
+    // clear it so that result is not taken for this channel's
+    ADC_REGS->ADC_INTFLAG = ADC_INTFLAG_RESRDY_Msk;
     
     // Start ADC conversion by software trigger
     ADC_REGS->ADC_SWTRIG = ADC_SWTRIG_START_Msk;
     // No SYNCBUSY for SWTRIG itself, but conversion takes time.
     
     // Wait for the conversion to be complete (Result Ready flag)
-    while (!(ADC_REGS->ADC_INTFLAG & ADC_INTFLAG_RESRDY_Msk));
+    if (wait_flag(&ADC_REGS->ADC_INTFLAG, ADC_INTFLAG_RESRDY_Msk, &deadline) != IO_OK) {
+        return IO_TIMEOUT;
+    }
     
     // Read the ADC result
-    uint16_t result = ADC_REGS->ADC_RESULT;
+    *result = ADC_REGS->ADC_RESULT;
 
     // Clear the Result Ready flag by writing a '1' to it (optional if only polling)
     ADC_REGS->ADC_INTFLAG = ADC_INTFLAG_RESRDY_Msk; 
     
-    return result;
+    return IO_OK;
+}
+ 
+/* I2C FUNCTIONS
+ * 
+ * SERCOM2 runs as an interrupt-driven I2C master. Callers queue a transaction
+ * (register write, then an optional repeated-start read) and carry on; the
+ * SERCOM2 interrupts move it over the bus and call its done function, from
+ * interrupt context, when it finishes. It consists of the following:
+ * [1] I2C Start / Complete
+ * [2] I2C Interrupt Handlers
+ * [3] I2C Submit
+ * [4] I2C Abort
+ */
+
+//Transaction queue (must be a power of two)
+#define I2C_QUEUE_SIZE 8
+#define I2C_QUEUE_MASK (I2C_QUEUE_SIZE - 1)
+
+//Status Bits
+#define I2C_STATUS_BUSERR (0x1 << 0)
+#define I2C_STATUS_ARBLOST (0x1 << 1)
+#define I2C_STATUS_RXNACK (0x1 << 2)
+
+//Commands
+#define I2C_CMD_READ (0x2 << 16)
+#define I2C_CMD_STOP (0x3 << 16)
+#define I2C_ACKACT_NACK (0x1 << 18)
+
+typedef enum {
+    I2C_IDLE = 0,
+    I2C_QUEUED,
+    I2C_BUSY,
+    I2C_DONE,
+    I2C_ERROR
+} I2C_State;
+
+// Structure to hold one bus transaction
+typedef struct I2C_Transaction {
+    uint8_t addr;
+    const uint8_t *wbuf;
+    uint8_t wlen;
+    uint8_t *rbuf;
+    uint8_t rlen;
+    uint8_t idx;
+    volatile I2C_State state;
+    void (*done)(struct I2C_Transaction *txn);
+} I2C_Transaction;
+
+static I2C_Transaction *i2c_queue[I2C_QUEUE_SIZE];
+static volatile uint8_t i2c_head = 0;
+static volatile uint8_t i2c_tail = 0;
+
+//This function waits for a SERCOM2 system operation, takes a few peripheral clocks
+static void i2c_sync(void){
+    while (SERCOM2_REGS->I2CM.SERCOM_SYNCBUSY & (0x1 << 2));
+}
+
+//This function puts the transaction at the front of the queue on the bus
+static void i2c_start(void){
+    if (i2c_tail == i2c_head) return;
+    
+    I2C_Transaction *txn = i2c_queue[i2c_tail];
+    txn->state = I2C_BUSY;
+    txn->idx = 0;
+    
+    //Writing ADDR generates the start condition
+    SERCOM2_REGS->I2CM.SERCOM_ADDR = (txn->addr << 1) | ((txn->wlen == 0) ? 1 : 0);
+    i2c_sync();
+}
+
+//This function finishes the front transaction and starts the next one
+static void i2c_complete(I2C_State state){
+    if (i2c_tail == i2c_head) return;
+    
+    I2C_Transaction *txn = i2c_queue[i2c_tail];
+    i2c_tail = (i2c_tail + 1) & I2C_QUEUE_MASK;
+    
+    txn->state = state;
+    if (txn->done != NULL) txn->done(txn);
+    
+    i2c_start();
+}
+
+//Master on Bus: address or data byte written
+void SERCOM2_0_Handler(void){
+    uint16_t status = SERCOM2_REGS->I2CM.SERCOM_STATUS;
+    I2C_Transaction *txn = i2c_queue[i2c_tail];
+    
+    //Nothing on the bus (aborted), just release it
+    if (i2c_tail == i2c_head){
+        SERCOM2_REGS->I2CM.SERCOM_CTRLB |= I2C_CMD_STOP;
+        i2c_sync();
+        return;
+    }
+    
+    //Lost arbitration or bus error, the hardware already let go of the bus.
+    //The same error raises the ERROR interrupt, clear it so only this
+    //transaction is completed and not the one started after it
+    if (status & (I2C_STATUS_ARBLOST | I2C_STATUS_BUSERR)){
+        SERCOM2_REGS->I2CM.SERCOM_INTFLAG = (0x1 << 0) | (0x1 << 7);
+        SERCOM2_REGS->I2CM.SERCOM_STATUS = I2C_STATUS_BUSERR | I2C_STATUS_ARBLOST;
+        i2c_complete(I2C_ERROR);
+        return;
+    }
+    
+    //No device at this address, or it refused a byte
+    if (status & I2C_STATUS_RXNACK){
+        SERCOM2_REGS->I2CM.SERCOM_CTRLB |= I2C_CMD_STOP;
+        i2c_sync();
+        i2c_complete(I2C_ERROR);
+        return;
+    }
+    
+    if (txn->idx < txn->wlen){
+        SERCOM2_REGS->I2CM.SERCOM_DATA = txn->wbuf[txn->idx++];
+    } else if (txn->rlen > 0){
+        //Repeated start for the read part
+        txn->idx = 0;
+        SERCOM2_REGS->I2CM.SERCOM_ADDR = (txn->addr << 1) | 1;
+        i2c_sync();
+    } else {
+        SERCOM2_REGS->I2CM.SERCOM_CTRLB |= I2C_CMD_STOP;
+        i2c_sync();
+        i2c_complete(I2C_DONE);
+    }
+}
+
+//Slave on Bus: data byte received
+void SERCOM2_1_Handler(void){
+    I2C_Transaction *txn = i2c_queue[i2c_tail];
+    
+    //Nothing on the bus (aborted), NACK and release it
+    if (i2c_tail == i2c_head){
+        SERCOM2_REGS->I2CM.SERCOM_CTRLB |= I2C_ACKACT_NACK | I2C_CMD_STOP;
+        i2c_sync();
+        return;
+    }
+    
+    bool last = (txn->idx == txn->rlen - 1);
+    
+    //NACK and stop after the last byte, ACK and read on otherwise
+    if (last){
+        SERCOM2_REGS->I2CM.SERCOM_CTRLB |= I2C_ACKACT_NACK;
+        SERCOM2_REGS->I2CM.SERCOM_CTRLB |= I2C_CMD_STOP;
+    } else {
+        SERCOM2_REGS->I2CM.SERCOM_CTRLB &= ~I2C_ACKACT_NACK;
+        SERCOM2_REGS->I2CM.SERCOM_CTRLB |= I2C_CMD_READ;
+    }
+    i2c_sync();
+    
+    txn->rbuf[txn->idx++] = SERCOM2_REGS->I2CM.SERCOM_DATA;
+    
+    if (last){
+        i2c_complete(I2C_DONE);
+    }
+}
+
+//Error: bus error, arbitration lost or SCL low timeout
+void SERCOM2_OTHER_Handler(void){
+    //Clear Master/Slave on Bus too, the error must not be handled again there
+    SERCOM2_REGS->I2CM.SERCOM_INTFLAG = (0x1 << 0) | (0x1 << 1) | (0x1 << 7);
+    SERCOM2_REGS->I2CM.SERCOM_STATUS = I2C_STATUS_BUSERR | I2C_STATUS_ARBLOST;
+    
+    if (i2c_tail != i2c_head){
+        i2c_complete(I2C_ERROR);
+    }
+}
+
+//This function queues a transaction, returns false if the queue is full
+static bool i2c_submit(I2C_Transaction *txn){
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    
+    uint8_t next = (i2c_head + 1) & I2C_QUEUE_MASK;
+    if (next == i2c_tail){
+        __set_PRIMASK(primask);
+        return false;
+    }
+    
+    bool idle = (i2c_tail == i2c_head);
+    txn->state = I2C_QUEUED;
+    i2c_queue[i2c_head] = txn;
+    i2c_head = next;
+    
+    if (idle) i2c_start();
+    
+    __set_PRIMASK(primask);
+    return true;
+}
+
+//This function drops everything queued and releases the bus, used when a device hangs it
+static void i2c_abort(void){
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    
+    while (i2c_tail != i2c_head){
+        i2c_queue[i2c_tail]->state = I2C_ERROR;
+        i2c_tail = (i2c_tail + 1) & I2C_QUEUE_MASK;
+    }
+    
+    SERCOM2_REGS->I2CM.SERCOM_CTRLB |= I2C_CMD_STOP;
+    i2c_sync();
+    SERCOM2_REGS->I2CM.SERCOM_STATUS = (0x1 << 4); // Force IDLE
+    i2c_sync();
+    
+    __set_PRIMASK(primask);
+}
+
+//This function runs one transaction to the end, only for start-up
+static IO_Status i2c_transfer(I2C_Transaction *txn, uint32_t timeout_ms){
+    Deadline deadline;
+    deadline_set(&deadline, timeout_ms);
+    
+    txn->done = NULL;
+    if (!i2c_submit(txn)) return IO_TIMEOUT;
+    
+    while (txn->state == I2C_QUEUED || txn->state == I2C_BUSY){
+        if (deadline_expired(&deadline)){
+            i2c_abort();
+            return IO_TIMEOUT;
+        }
+    }
+    
+    //NACK, bus error or lost arbitration
+    return (txn->state == I2C_DONE) ? IO_OK : IO_ERROR;
+}
+
+/* BME280 FUNCTIONS
+ * 
+ * The BME280 runs in normal mode, measuring on its own about 60 times a second.
+ * Every TC0 wrap (100 ms) queues a burst read of its 8 data registers; the
+ * done function compensates the raw values and accumulates them, and the
+ * main loop averages whatever accumulated since the previous frame. It consists of the following:
+ * [1] BME280 Initialize Function
+ * [2] BME280 Compensation (Bosch integer formulas)
+ * [3] BME280 Sample Tick / Done
+ * [4] BME280 Take Readings
+ */
+
+#define BME280_ADDR 0x76
+#define BME280_CHIP_ID 0x60
+#define BME280_TIMEOUT_MS 20
+#define SEA_LEVEL_PRESSURE_PA 101325.0f
+
+//Registers
+#define BME280_REG_CALIB00 0x88
+#define BME280_REG_ID 0xD0
+#define BME280_REG_RESET 0xE0
+#define BME280_REG_CALIB26 0xE1
+#define BME280_REG_CTRL_HUM 0xF2
+#define BME280_REG_CTRL_MEAS 0xF4
+#define BME280_REG_CONFIG 0xF5
+#define BME280_REG_DATA 0xF7
+
+// Structure to hold the factory calibration of the sensor
+typedef struct {
+    uint16_t T1;
+    int16_t T2, T3;
+    uint16_t P1;
+    int16_t P2, P3, P4, P5, P6, P7, P8, P9;
+    uint8_t H1, H3;
+    int16_t H2, H4, H5;
+    int8_t H6;
+} BME280_Calib;
+
+// Structure to hold the readings averaged for one frame
+typedef struct {
+    float humidity;    // %RH
+    float pressure;    // Pa
+    float altitude;    // m
+} BME280_Readings;
+
+static BME280_Calib bme280_calib;
+static volatile bool bme280_ready = false;
+
+//Burst read transaction queued by the TC0 tick
+static const uint8_t bme280_data_reg = BME280_REG_DATA;
+static uint8_t bme280_raw[8];
+static I2C_Transaction bme280_sample_txn;
+static uint8_t bme280_busy_ticks = 0;
+
+//Accumulated since the last frame, written by the done function
+static volatile uint64_t bme280_sum_p = 0; // Pa
+static volatile uint64_t bme280_sum_h = 0; // 1/1024 %RH
+static volatile uint16_t bme280_count = 0;
+
+//Temperature in 0.01 C, also gives t_fine for pressure and humidity
+static int32_t bme280_compensate_t(int32_t adc_t, int32_t *t_fine){
+    int32_t var1 = ((((adc_t >> 3) - ((int32_t)bme280_calib.T1 << 1))) * ((int32_t)bme280_calib.T2)) >> 11;
+    int32_t var2 = (((((adc_t >> 4) - ((int32_t)bme280_calib.T1)) * ((adc_t >> 4) - ((int32_t)bme280_calib.T1))) >> 12) *
+                    ((int32_t)bme280_calib.T3)) >> 14;
+    *t_fine = var1 + var2;
+    return (*t_fine * 5 + 128) >> 8;
+}
+
+//Pressure in Pa (Q24.8 from the formula, shifted down)
+static uint32_t bme280_compensate_p(int32_t adc_p, int32_t t_fine){
+    int64_t var1 = ((int64_t)t_fine) - 128000;
+    int64_t var2 = var1 * var1 * (int64_t)bme280_calib.P6;
+    var2 = var2 + ((var1 * (int64_t)bme280_calib.P5) << 17);
+    var2 = var2 + (((int64_t)bme280_calib.P4) << 35);
+    var1 = ((var1 * var1 * (int64_t)bme280_calib.P3) >> 8) + ((var1 * (int64_t)bme280_calib.P2) << 12);
+    var1 = (((((int64_t)1) << 47) + var1)) * ((int64_t)bme280_calib.P1) >> 33;
+    if (var1 == 0) return 0;
+    
+    int64_t p = 1048576 - adc_p;
+    p = (((p << 31) - var2) * 3125) / var1;
+    var1 = (((int64_t)bme280_calib.P9) * (p >> 13) * (p >> 13)) >> 25;
+    var2 = (((int64_t)bme280_calib.P8) * p) >> 19;
+    p = ((p + var1 + var2) >> 8) + (((int64_t)bme280_calib.P7) << 4);
+    
+    return (uint32_t)(p >> 8);
+}
+
+//Humidity in 1/1024 %RH
+static uint32_t bme280_compensate_h(int32_t adc_h, int32_t t_fine){
+    int32_t v = t_fine - ((int32_t)76800);
+    v = (((((adc_h << 14) - (((int32_t)bme280_calib.H4) << 20) - (((int32_t)bme280_calib.H5) * v)) +
+           ((int32_t)16384)) >> 15) *
+         (((((((v * ((int32_t)bme280_calib.H6)) >> 10) * (((v * ((int32_t)bme280_calib.H3)) >> 11) +
+              ((int32_t)32768))) >> 10) + ((int32_t)2097152)) * ((int32_t)bme280_calib.H2) + 8192) >> 14));
+    v = (v - (((((v >> 15) * (v >> 15)) >> 7) * ((int32_t)bme280_calib.H1)) >> 4));
+    v = (v < 0) ? 0 : v;
+    v = (v > 419430400) ? 419430400 : v;
+    
+    return (uint32_t)(v >> 12);
+}
+
+//Done function of the burst read, runs in the SERCOM2 interrupt
+static void bme280_sample_done(I2C_Transaction *txn){
+    if (txn->state != I2C_DONE) return;
+    
+    const uint8_t *r = bme280_raw;
+    int32_t adc_p = ((int32_t)r[0] << 12) | ((int32_t)r[1] << 4) | (r[2] >> 4);
+    int32_t adc_t = ((int32_t)r[3] << 12) | ((int32_t)r[4] << 4) | (r[5] >> 4);
+    int32_t adc_h = ((int32_t)r[6] << 8) | r[7];
+    int32_t t_fine;
+    
+    bme280_compensate_t(adc_t, &t_fine);
+    bme280_sum_p += bme280_compensate_p(adc_p, t_fine);
+    bme280_sum_h += bme280_compensate_h(adc_h, t_fine);
+    bme280_count++;
+}
+
+//This function is called by the TC0 interrupt every 100 ms
+void bme280_sample_tick(void){
+    if (!bme280_ready) return;
+    
+    //The previous read is still on the bus, give a hung bus a few ticks then free it
+    if (bme280_sample_txn.state == I2C_QUEUED || bme280_sample_txn.state == I2C_BUSY){
+        if (++bme280_busy_ticks >= 5){
+            bme280_busy_ticks = 0;
+            i2c_abort();
+        }
+        return;
+    }
+    bme280_busy_ticks = 0;
+    
+    bme280_sample_txn.addr = BME280_ADDR;
+    bme280_sample_txn.wbuf = &bme280_data_reg;
+    bme280_sample_txn.wlen = 1;
+    bme280_sample_txn.rbuf = bme280_raw;
+    bme280_sample_txn.rlen = sizeof(bme280_raw);
+    bme280_sample_txn.done = bme280_sample_done;
+    i2c_submit(&bme280_sample_txn);
+}
+
+//This function reads registers at start-up
+static IO_Status bme280_read_regs(uint8_t reg, uint8_t *data, uint8_t len){
+    I2C_Transaction txn = { .addr = BME280_ADDR, .wbuf = &reg, .wlen = 1, .rbuf = data, .rlen = len };
+    return i2c_transfer(&txn, BME280_TIMEOUT_MS);
+}
+
+//This function writes one register at start-up
+static IO_Status bme280_write_reg(uint8_t reg, uint8_t value){
+    uint8_t buf[2] = { reg, value };
+    I2C_Transaction txn = { .addr = BME280_ADDR, .wbuf = buf, .wlen = 2 };
+    return i2c_transfer(&txn, BME280_TIMEOUT_MS);
+}
+
+//This function is for BME280 Initialization
+IO_Status BME280_Initialize(void){
+    uint8_t id = 0;
+    uint8_t c[26];
+    uint8_t h[7];
+    IO_Status status;
+    
+    //A NACK here means nothing answers at the address, a timeout a hung bus
+    if ((status = bme280_read_regs(BME280_REG_ID, &id, 1)) != IO_OK) return status;
+    if (id != BME280_CHIP_ID) return IO_ERROR;
+    
+    //Soft reset, then give the sensor time to copy its calibration
+    bme280_write_reg(BME280_REG_RESET, 0xB6);
+    ms_delay(5);
+    
+    //Calibration Data
+    if ((status = bme280_read_regs(BME280_REG_CALIB00, c, sizeof(c))) != IO_OK) return status;
+    if ((status = bme280_read_regs(BME280_REG_CALIB26, h, sizeof(h))) != IO_OK) return status;
+    
+    bme280_calib.T1 = (uint16_t)(c[0] | (c[1] << 8));
+    bme280_calib.T2 = (int16_t)(c[2] | (c[3] << 8));
+    bme280_calib.T3 = (int16_t)(c[4] | (c[5] << 8));
+    bme280_calib.P1 = (uint16_t)(c[6] | (c[7] << 8));
+    bme280_calib.P2 = (int16_t)(c[8] | (c[9] << 8));
+    bme280_calib.P3 = (int16_t)(c[10] | (c[11] << 8));
+    bme280_calib.P4 = (int16_t)(c[12] | (c[13] << 8));
+    bme280_calib.P5 = (int16_t)(c[14] | (c[15] << 8));
+    bme280_calib.P6 = (int16_t)(c[16] | (c[17] << 8));
+    bme280_calib.P7 = (int16_t)(c[18] | (c[19] << 8));
+    bme280_calib.P8 = (int16_t)(c[20] | (c[21] << 8));
+    bme280_calib.P9 = (int16_t)(c[22] | (c[23] << 8));
+    bme280_calib.H1 = c[25];
+    bme280_calib.H2 = (int16_t)(h[0] | (h[1] << 8));
+    bme280_calib.H3 = h[2];
+    bme280_calib.H4 = (int16_t)(((int8_t)h[3] * 16) | (h[4] & 0x0F));
+    bme280_calib.H5 = (int16_t)(((int8_t)h[5] * 16) | (h[4] >> 4));
+    bme280_calib.H6 = (int8_t)h[6];
+    
+    //Humidity x1 (must come before CTRL_MEAS) | Standby 0.5 ms, Filter x4 | Temp x1, Pressure x4, Normal Mode
+    if ((status = bme280_write_reg(BME280_REG_CTRL_HUM, 0x01)) != IO_OK) return status;
+    if ((status = bme280_write_reg(BME280_REG_CONFIG, (0x0 << 5) | (0x2 << 2))) != IO_OK) return status;
+    if ((status = bme280_write_reg(BME280_REG_CTRL_MEAS, (0x1 << 5) | (0x3 << 2) | 0x3)) != IO_OK) return status;
+    
+    bme280_ready = true;
+    return IO_OK;
+}
+
+//This function averages the samples taken since the last call, false if there were none
+static bool bme280_take_readings(BME280_Readings *readings){
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    
+    uint64_t sum_p = bme280_sum_p;
+    uint64_t sum_h = bme280_sum_h;
+    uint16_t count = bme280_count;
+    bme280_sum_p = 0;
+    bme280_sum_h = 0;
+    bme280_count = 0;
+    
+    __set_PRIMASK(primask);
+    
+    if (count == 0) return false;
+    
+    readings->pressure = (float)sum_p / count;
+    readings->humidity = (float)sum_h / count / 1024.0f;
+    readings->altitude = 44330.0f * (1.0f - powf(readings->pressure / SEA_LEVEL_PRESSURE_PA, 0.1903f));
+    
+    return true;
 }
  
  /* HC12 MODULE FUNCTIONS
  * 
- * The following functions are used for reading and sending data to the module. It consists of the following:
- * [1] HC12 Send Message
- * [2] HC12 Receive Message
+ * The following functions are used for sending and receiving data from the module. It consists of the following:
+ * [1] HC12 Send Frame
+ * [2] HC12 Send Message
+ * [3] HC12 RX Interrupt Handler
+ * [4] HC12 Uplink Service (NACK handling)
+ * [5] HC12 Backfill
  */
+
+//Uplink RX Ring Buffer (must be a power of two)
+#define UPLINK_RING_SIZE 64
+#define UPLINK_RING_MASK (UPLINK_RING_SIZE - 1)
+
+//Pending resend queue and how many resends fit in the idle air time of one cycle
+#define RESEND_QUEUE_SIZE 16
+#define HC12_BACKFILL_PER_CYCLE 2
+
+//Quiet time after a live frame while the ground station's NACK is on the air
+#define HC12_NACK_GUARD_MS 150
+
+//UART time of one byte to the HC12 in microseconds, 10 bits at 9600 bps
+#define HC12_BYTE_US 1042
+
+//Room kept on top of a reserved resend for the GPS timeout and report formatting
+#define HC12_RESERVE_SLACK_MS 20
+
+// Structure to hold one sent frame in the history
+typedef struct {
+    bool valid;
+    uint16_t seq;
+    uint16_t len;
+    uint8_t bytes[HC12_MAX_FRAME];
+} HC12_History;
+
+//Sequence number of the next frame
+static uint16_t hc12_tx_seq = 0;
+
+//Ring of the last frames sent, indexed by sequence number
+static HC12_History hc12_history[HC12_HISTORY_DEPTH];
+
+//Sequence numbers requested by the ground station
+static uint16_t resend_queue[RESEND_QUEUE_SIZE];
+static uint8_t resend_count = 0;
+
+//Uplink RX Ring Buffer, written by the RXC interrupt only
+static volatile uint8_t uplink_ring[UPLINK_RING_SIZE];
+static volatile uint8_t uplink_head = 0;
+static volatile uint8_t uplink_tail = 0;
+
+//Uplink Frame Parser
+static HC12_Parser uplink_parser;
+
+//When the last byte of the previous live frame left the UART, for the trace block.
+//0 when the previous send failed and the end is not known
+static uint32_t hc12_last_tx_end_ms = 0;
+
+//This function is used to push raw frame bytes to the HC12 Module
+static IO_Status hc12_send_frame(const uint8_t *frame, uint32_t len){
+    // TX Handling, a cut-off frame is dropped by the receiver's CRC check
+    for (uint32_t i = 0; i < len; i++) {
+        if (uart_write_byte(SERCOM0_REGS, frame[i]) != IO_OK) return IO_TIMEOUT;
+    }
+    
+    return IO_OK;
+}
  
  //This function is used to send messages to the HC12 Module
-static void hc12_send_msg(const char *message){
-    
-    print_terminal(message);
+static void hc12_send_msg(const char *message, HC12_Trace *trace){
+    static uint8_t payload[HC12_MAX_PAYLOAD];
     
     if (message == NULL) return;
     
-    // TX Handling
-    while (*message) {
-        while (!(SERCOM0_REGS->USART_INT.SERCOM_INTFLAG & (1 << 0)));
-        SERCOM0_REGS->USART_INT.SERCOM_DATA = *message++;
+    LOG_TRACE(message);
+    
+    //Trace block first, then the report text
+    size_t len = strlen(message);
+    if (len > HC12_MAX_REPORT) len = HC12_MAX_REPORT;
+    memcpy(&payload[HC12_TRACE_LEN], message, len);
+    
+    trace->tx_start_ms = time_now_ms();
+    trace->prev_tx_end_ms = hc12_last_tx_end_ms;
+    hc12_trace_put(payload, trace);
+    
+    //Wrap the payload in a frame, straight into its history slot
+    HC12_History *entry = &hc12_history[hc12_tx_seq % HC12_HISTORY_DEPTH];
+    entry->seq = hc12_tx_seq++;
+    entry->len = (uint16_t)hc12_frame_encode(HC12_TYPE_TELEMETRY, entry->seq,
+                                             payload, (uint16_t)(HC12_TRACE_LEN + len), entry->bytes);
+    entry->valid = true;
+    
+    //A stale end time would pass as the end of this frame, the ground reads 0 as not measured
+    hc12_last_tx_end_ms = 0;
+    
+    if (hc12_send_frame(entry->bytes, entry->len) != IO_OK){
+        LOG_ERROR("HC12 TX timeout\r\n");
+        return;
+    }
+    
+    //Wait for TXC (cleared by every DATA write) so the stamp is the end of the last stop bit
+    Deadline deadline;
+    deadline_set(&deadline, UART_BYTE_TIMEOUT_MS);
+    if (wait_flag(&SERCOM0_REGS->USART_INT.SERCOM_INTFLAG, (1 << 1), &deadline) == IO_OK){
+        hc12_last_tx_end_ms = time_now_ms();
     }
     
     //Exit
     return;
 }
 
-//This function is used to receive messages from the HC12 Module
-static void hc12_rcvd_msg(char *message, uint32_t len){
-    int rcvd_idx = 0;
+//This interrupt pushes every uplink byte into the ring buffer
+void SERCOM0_2_Handler(void){
+    //Frame, parity or buffer overflow errors
+    uint16_t status = SERCOM0_REGS->USART_INT.SERCOM_STATUS;
+    if (status & 0x07){
+        SERCOM0_REGS->USART_INT.SERCOM_STATUS = status & 0x07;
+    }
+    
+    //Reading DATA also clears RXC
+    uint8_t data = SERCOM0_REGS->USART_INT.SERCOM_DATA;
+    uint8_t next = (uplink_head + 1) & UPLINK_RING_MASK;
     
-    while (rcvd_idx < len - 1){
-        //Do not return the character until RXC is clear
-        while(!(SERCOM0_REGS->USART_INT.SERCOM_INTFLAG & (0x1 << 2)));
+    //A full ring just loses the byte, the ground station will NACK again
+    if (next != uplink_tail){
+        uplink_ring[uplink_head] = data;
+        uplink_head = next;
+    }
+}
+
+//This function queues a resend if the frame is still in the history
+static void hc12_queue_resend(uint16_t seq){
+    const HC12_History *entry = &hc12_history[seq % HC12_HISTORY_DEPTH];
+    
+    if (!entry->valid || entry->seq != seq) return;
+    
+    for (uint8_t i = 0; i < resend_count; i++){
+        if (resend_queue[i] == seq) return;
+    }
+    
+    if (resend_count < RESEND_QUEUE_SIZE){
+        resend_queue[resend_count++] = seq;
+    }
+}
+
+//This function decodes the uplink bytes received so far and handles the NACKs
+static void hc12_service_uplink(void){
+    while (uplink_tail != uplink_head){
+        uint8_t data = uplink_ring[uplink_tail];
+        uplink_tail = (uplink_tail + 1) & UPLINK_RING_MASK;
+        
+        if (!hc12_parser_feed(&uplink_parser, data)) continue;
+        
+        const HC12_Frame *frame = &uplink_parser.frame;
+        if (frame->type != HC12_TYPE_NACK || frame->len != HC12_NACK_LEN) continue;
+        
+        //NACK Payload: first missing sequence number and how many follow it
+        uint16_t first = (uint16_t)(frame->payload[0] | (frame->payload[1] << 8));
+        uint8_t count = frame->payload[2];
         
-        //Append to the message buffer
-        message[rcvd_idx++] = SERCOM1_REGS->USART_INT.SERCOM_DATA;  
+        for (uint8_t i = 0; i < count; i++){
+            hc12_queue_resend((uint16_t)(first + i));
+        }
     }
+}
+
+//This function returns the UART time of a frame to the HC12 in ms
+static uint32_t hc12_air_ms(uint32_t len){
+    return (len * HC12_BYTE_US) / 1000 + 1;
+}
+
+//This function waits until the NACK for the previous live frame is through,
+//false if the frame deadline came first
+static bool hc12_wait_nack_guard(const Deadline *frame_due){
+    //End of the previous frame unknown, nothing to wait for
+    if (hc12_last_tx_end_ms == 0) return true;
     
-    //Print Terminal
-    print_terminal(message);
+    Deadline guard;
+    guard.expires_ms = hc12_last_tx_end_ms + HC12_NACK_GUARD_MS;
+    while (!deadline_expired(&guard)){
+        if (deadline_expired(frame_due)) return false;
+    }
     
-    //Exit
-    return;
+    return true;
+}
+
+//This function returns how long before the frame deadline the GPS wait has to end
+//so the oldest requested resend still goes out this cycle, 0 if nothing is asked for
+static uint32_t hc12_backfill_reserve_ms(const Deadline *frame_due){
+    //The NACK for the previous live frame is in once the guard time has passed
+    if (!hc12_wait_nack_guard(frame_due)) return 0;
+    
+    hc12_service_uplink();
+    
+    //Forget requests whose history slot has been reused
+    while (resend_count > 0){
+        const HC12_History *entry = &hc12_history[resend_queue[0] % HC12_HISTORY_DEPTH];
+        if (entry->valid && entry->seq == resend_queue[0]) return hc12_air_ms(entry->len) + HC12_RESERVE_SLACK_MS;
+        
+        resend_count--;
+        memmove(&resend_queue[0], &resend_queue[1], resend_count * sizeof(resend_queue[0]));
+    }
+    
+    return 0;
+}
+
+//This function resends requested frames, the NACKs arrive while we wait on the sensors
+static void hc12_backfill(const Deadline *frame_due){
+    uint8_t sent = 0;
+    
+    hc12_service_uplink();
+    
+    if (resend_count == 0) return;
+    
+    //The HC12 is half-duplex, stay off the air until the NACK is through
+    if (!hc12_wait_nack_guard(frame_due)) return;
+    
+    while (resend_count > 0 && sent < HC12_BACKFILL_PER_CYCLE){
+        uint16_t seq = resend_queue[0];
+        
+        //A resend that would run past the frame deadline waits for the next cycle
+        const HC12_History *next = &hc12_history[seq % HC12_HISTORY_DEPTH];
+        if ((int32_t)(frame_due->expires_ms - time_now_ms()) < (int32_t)hc12_air_ms(next->len)) break;
+        
+        //Oldest request first
+        resend_count--;
+        memmove(&resend_queue[0], &resend_queue[1], resend_count * sizeof(resend_queue[0]));
+        
+        //The slot may have been reused since the NACK came in
+        const HC12_History *entry = &hc12_history[seq % HC12_HISTORY_DEPTH];
+        if (!entry->valid || entry->seq != seq) continue;
+        
+        hc12_send_frame(entry->bytes, entry->len);
+        sent++;
+    }
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -386,33 +1093,46 @@ void main_program() {
     char pm_read_str[32] = {0};
     char temp_read_str[32] = {0};
     char humid_read_str[32] = {0};
-    char output_msg[256] = {0};
+    char baro_read_str[64] = {0};
+    char output_msg[HC12_MAX_REPORT + 1] = {0};
     
-    // Flags for synchronization
-    bool gps_on = false;
-    bool co2_on = false;
-    bool pm_on = false;
-    bool temp_on = false;
-    bool alt_on = false;
+    //Raw ADC Readings
+    uint16_t adc_read = 0;
+    
+    //BME280 Readings, sampled at 10 Hz in the background
+    BME280_Readings baro;
     
     //GPS Data Structure Initialization
     GPS_Data gps_data;
     
+    //Stage stamps carried in the frame
+    HC12_Trace trace;
+    
+    //The frame leaves by this deadline whatever the GPS does. It is armed
+    //here, after the previous live frame, and the resends are budgeted
+    //against it so no blocking TX eats into the GPS wait
+    Deadline frame_due;
+    deadline_set(&frame_due, FRAME_PERIOD_MS);
+    
     //Protocol Header;
     strcat(output_msg, "[D.L~N~R]\n");
+    trace.acquire_ms = time_now_ms();
    
     //MQ-135 Sensor Data Readings    
     do{
-        int c02_adc_read = ADC_Read_Channel(CO2_ADC_CHANNEL);
+        if (ADC_Read_Channel(CO2_ADC_CHANNEL, &adc_read) != IO_OK){
+            strcat(output_msg, "C02 Readings: N/A\n");
+            LOG_ERROR("CO2 ADC timeout\r\n");
+            break;
+        }
+        
+        int c02_adc_read = adc_read;
         double c02_voltage = c02_adc_read*(ADC_ACTUAL_REF_VOLTAGE / ADC_MAX_VALUE);
         double c02_read = (c02_voltage*100) + 400;
         
         snprintf(c02_read_str, sizeof(c02_read_str), "C02 Readings: %.3f PPM\n", c02_read);
         strcat(output_msg, c02_read_str);
         
-        //For Synchronization of Data
-        co2_on = true;
-
         //Exit
         break;
         
@@ -420,7 +1140,13 @@ void main_program() {
     
     //LM35 Sensor Data Readings
     do{
-        int temp_adc_read = ADC_Read_Channel(LM35_ADC_CHANNEL);
+        if (ADC_Read_Channel(LM35_ADC_CHANNEL, &adc_read) != IO_OK){
+            strcat(output_msg, "Temperature Readings: N/A\n");
+            LOG_ERROR("LM35 ADC timeout\r\n");
+            break;
+        }
+        
+        int temp_adc_read = adc_read;
         float temp_voltage = temp_adc_read * (ADC_ACTUAL_REF_VOLTAGE / ADC_MAX_VALUE) ;
         float temp_read = (temp_voltage * 1000.0f) / LM35_MV_PER_DEGREE_C;
         
@@ -428,14 +1154,25 @@ void main_program() {
         strcat(output_msg, temp_read_str);
         strcat(output_msg, "\n");
         
-        //Humidity Sensor Readings
-        float humid_read = 100*(exp((17.675*DEW_POINT)/(234.04+DEW_POINT))/exp((17.675*temp_read)/(234.04+temp_read)));
+        //Exit
+        break;
+        
+    }while(0);
+    
+    //BME280 Sensor Data Readings
+    do{
+        if (!bme280_take_readings(&baro)){
+            strcat(output_msg, "Humidity Reading: N/A\n");
+            strcat(output_msg, "Pressure: N/A\n");
+            break;
+        }
         
-        snprintf(humid_read_str, sizeof(humid_read_str), "Humidity Reading: %.2f % \n", humid_read);        ;
-        strcat(output_msg, humid_read_str);  
+        snprintf(humid_read_str, sizeof(humid_read_str), "Humidity Reading: %.2f %%\n", baro.humidity);
+        strcat(output_msg, humid_read_str);
         
-        //For synchronization of data
-        temp_on = true;
+        snprintf(baro_read_str, sizeof(baro_read_str), "Pressure: %.2f hPa\nBaro Altitude: %.2f m\n",
+                 baro.pressure / 100.0f, baro.altitude);
+        strcat(output_msg, baro_read_str);
         
         //Exit
         break;
@@ -444,7 +1181,13 @@ void main_program() {
     
     //PM2.5 Sensor Data Readings    
     do{
-        int pm_adc_read = ADC_Read_Channel(DUST_ADC_CHANNEL);
+        if (ADC_Read_Channel(DUST_ADC_CHANNEL, &adc_read) != IO_OK){
+            strcat(output_msg, "PM Readings: N/A\n");
+            LOG_ERROR("Dust ADC timeout\r\n");
+            break;
+        }
+        
+        int pm_adc_read = adc_read;
         double pm_voltage = pm_adc_read * (ADC_ACTUAL_REF_VOLTAGE / ADC_MAX_VALUE);
         double pm_read = ((pm_voltage - DUST_OFFSET) / DUST_SENSITIVITY * 0.1f) *0.046888f;
         
@@ -456,47 +1199,52 @@ void main_program() {
         snprintf(pm_read_str, sizeof(pm_read_str), "PM Readings: %.8f mg/m^3\n", pm_read);        
         strcat(output_msg, pm_read_str);
         
-        //For synchronization of data
-        pm_on = true;
-        
         //Exit
         break;
         
     }while(0);   
 
+    //The GPS wait ends early enough for the oldest requested resend to fit
+    //before the frame deadline, even when the GPS never answers
+    Deadline gps_due = frame_due;
+    gps_due.expires_ms -= hc12_backfill_reserve_ms(&frame_due);
+
     //GY-NE06MV2 Readings
     do{
         
-        gps_received_msg(gps_read_str, sizeof(gps_read_str));
+        //A quiet or disconnected GPS must not hold back the frame
+        if (gps_received_msg(gps_read_str, sizeof(gps_read_str), &gps_due) != IO_OK){
+            strcat(output_msg, "GPS: N/A\n");
+            LOG_ERROR("GPS timeout\r\n");
+            break;
+        }
         
         // Parse the GPS data into structured format
         parse_gps_data(gps_read_str, &gps_data);
+        if (gps_data.field_count < MAX_GPS_FIELDS){
+            strcat(output_msg, "GPS: No Fix\n");
+            break;
+        }
 
         // Process and format the GPS data
         process_gps_data(&gps_data, output_msg);
         
-        //For synchronization of data
-        gps_on = true;
-        
         //Exit
         break;
         
     }while(0);
 
         
-    //Send the data 
-    hc12_send_msg(output_msg);
-    
+    trace.ready_ms = time_now_ms();
     
-    //Send the data readings
-    if (gps_on && co2_on && pm_on && temp_on) { 
+    //Resend whatever the ground station reported missing, its NACK went out
+    //right after our previous live frame. The oldest request always fits,
+    //a second one only if the GPS answered early
+    hc12_backfill(&frame_due);
         
-        //Add another newline
-        strcat(output_msg, "\n");
-        
-        //Send the data 
-        hc12_send_msg(output_msg);
-    }
+    //Send the data readings, even when some of them are missing
+    strcat(output_msg, "\n");
+    hc12_send_msg(output_msg, &trace);
      
       
     //Exit the function
@@ -514,7 +1262,18 @@ int main(void) {
     //ADC Initialization
     ADC_Initialize();
     
-    print_terminal("Program Initialize for the Transmitter...\r\n");
+    //Uplink Parser Initialization
+    hc12_parser_reset(&uplink_parser);
+    
+    LOG_INFO("Program Initialize for the Transmitter...\r\n");
+    
+    //BME280 Initialization, the frames carry N/A if it is missing
+    IO_Status bme280_status = BME280_Initialize();
+    if (bme280_status == IO_ERROR){
+        LOG_ERROR("BME280 not found\r\n");
+    } else if (bme280_status == IO_TIMEOUT){
+        LOG_ERROR("BME280 I2C bus hung\r\n");
+    }
     
     for (;;){
         main_program();       
@@ -522,4 +1281,4 @@ int main(void) {
     
     // This line must never be reached    
     return 1;
-}
\ No newline at end of file
+}